@@ -0,0 +1,83 @@
+//
+// Created by wuggy on 17/10/26.
+//
+
+#ifndef AOC2018_ALL_DAYS_H
+#define AOC2018_ALL_DAYS_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../day01/day01.h"
+#include "../day02/day02.h"
+#include "../day03/day03.h"
+#include "../day04/day04.h"
+#include "../day05/day05.h"
+#include "../day06/day06.h"
+#include "../day07/day07.h"
+#include "../day08/day08.h"
+#include "../day09/day09.h"
+#include "../day10/day10.h"
+#include "../day11/day11.h"
+#include "../day12/day12.h"
+#include "../day13/day13.h"
+#include "../day14/day14.h"
+#include "../day15/day15.h"
+#include "../day16/day16.h"
+#include "../day17/day17.h"
+#include "../day18/day18.h"
+#include "../day19/day19.h"
+#include "../day20/day20.h"
+#include "../day21/day21.h"
+#include "../day22/day22.h"
+#include "../day23/day23.h"
+#include "../day24/day24.h"
+#include "../day25/day25.h"
+
+// Every day's solver, for the programs that run more than one of them (link with aoc_days to get them all).
+
+
+struct DayEntry
+{
+    std::string name;   // "day01" etc, which is also the directory its input is in
+    std::unique_ptr<Solver> (*make_solver)();
+};
+
+
+inline const std::vector<DayEntry>& all_days()
+{
+    static const std::vector<DayEntry> days
+            {
+                    {"day01", day01::make_solver}, {"day02", day02::make_solver}, {"day03", day03::make_solver},
+                    {"day04", day04::make_solver}, {"day05", day05::make_solver}, {"day06", day06::make_solver},
+                    {"day07", day07::make_solver}, {"day08", day08::make_solver}, {"day09", day09::make_solver},
+                    {"day10", day10::make_solver}, {"day11", day11::make_solver}, {"day12", day12::make_solver},
+                    {"day13", day13::make_solver}, {"day14", day14::make_solver}, {"day15", day15::make_solver},
+                    {"day16", day16::make_solver}, {"day17", day17::make_solver}, {"day18", day18::make_solver},
+                    {"day19", day19::make_solver}, {"day20", day20::make_solver}, {"day21", day21::make_solver},
+                    {"day22", day22::make_solver}, {"day23", day23::make_solver}, {"day24", day24::make_solver},
+                    {"day25", day25::make_solver}
+            };
+    return days;
+}
+
+
+// find a day by its name ("day07"), or just its number ("07" or "7"), or nullptr if there's no such day
+inline const DayEntry* find_day(const std::string& name)
+{
+    std::string full_name = name;
+    if (!name.empty() && name.find_first_not_of("0123456789") == std::string::npos)
+    {
+        full_name = (name.size() == 1 ? "day0" : "day") + name;
+    }
+
+    for (const auto& day : all_days())
+    {
+        if (day.name == full_name) return &day;
+    }
+    return nullptr;
+}
+
+
+#endif //AOC2018_ALL_DAYS_H
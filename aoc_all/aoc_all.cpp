@@ -0,0 +1,102 @@
+#include <chrono>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "all_days.h"
+#include "../util/trace.h"
+
+#include "tbb/task_group.h"
+
+// Runs every day at once, in the one process, and prints their answers (in order) with how long each took.
+// The whole lot should take about as long as the slowest day, rather than the sum of all of them.
+//
+//     aoc_all [repo-dir] [--trace <file>]
+//
+// Each day reads its input from its own directory under repo-dir (the current directory by default).
+// With --trace, the spans of every day (and whichever threads ran them) are written to a file, see util/trace.h.
+
+
+struct DayRun
+{
+    const DayEntry& day;
+
+    std::string part1 = {};
+    std::string part2 = {};
+    std::string error = {};
+    double seconds = 0;
+};
+
+
+int main(int argc, char* argv[])
+{
+    typedef std::chrono::steady_clock clock;
+    std::string root = ".";
+    std::string trace_filename;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--trace" && i + 1 < argc) trace_filename = argv[++i];
+        else root = arg;
+    }
+
+    std::vector<DayRun> days;
+    for (const auto& day : all_days()) days.push_back({day});
+
+    const auto start = clock::now();
+
+    tbb::task_group tasks;
+    for (auto& run : days)
+    {
+        tasks.run([&run, &root]
+        {
+            AOC_TRACE_SCOPE(run.day.name.c_str());
+            const auto day_start = clock::now();
+            try
+            {
+                auto solver = run.day.make_solver();
+                solver->parse(root + "/" + run.day.name);
+                run.part1 = solver->part1();
+                run.part2 = solver->part2();
+            }
+            catch (const std::exception& e)
+            {
+                run.error = e.what();
+            }
+            run.seconds = std::chrono::duration<double>(clock::now() - day_start).count();
+        });
+    }
+    tasks.wait();
+
+    const double wall_seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+    // now the answers, in order
+    double summed_seconds = 0;
+    bool failed = false;
+    std::cout << std::fixed << std::setprecision(1);
+    for (const auto& run : days)
+    {
+        std::cout << run.day.name << " (" << run.seconds * 1000 << "ms)" << std::endl;
+        if (!run.error.empty())
+        {
+            std::cout << "failed: " << run.error << std::endl;
+            failed = true;
+        }
+        else
+        {
+            std::cout << run.part1 << std::endl;
+            if (!run.part2.empty()) std::cout << run.part2 << std::endl;
+        }
+
+        summed_seconds += run.seconds;
+    }
+
+    std::cout << "all days: " << wall_seconds * 1000 << "ms (" << summed_seconds * 1000 << "ms for the days one after another)" << std::endl;
+
+    if (!trace_filename.empty() && !trace_write_file(trace_filename)) failed = true;
+
+    return failed ? 1 : 0;
+}
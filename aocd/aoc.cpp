@@ -0,0 +1,132 @@
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "protocol.h"
+#include "../util/file_parsing.h"
+
+// The client for aocd: asks the daemon for a day's answers instead of running the day's own binary.
+//
+//     aoc <day> [--part 1|2] [--input <dir-or-file>] [--inline] [--socket <path>]
+//     aoc --shutdown [--socket <path>]
+//
+// The day is its number or name (7, 07 or day07). Like the day binaries, the input is the current directory's
+// input.txt unless --input says otherwise. With --inline the input file's contents are sent, rather than its
+// path (for a daemon that can't see the same files). Without --part both parts are solved.
+//
+// The answers go to stdout just as the day would print them, and the timings to stderr.
+
+
+int usage()
+{
+    std::cerr << "usage: aoc <day> [--part 1|2] [--input <dir-or-file>] [--inline] [--socket <path>]" << std::endl;
+    std::cerr << "       aoc --shutdown [--socket <path>]" << std::endl;
+    return 1;
+}
+
+
+// read a reply, giving the answer (and writing the timings to stderr), or throwing with the daemon's error
+std::string read_reply(Connection& connection, const std::string& what)
+{
+    std::string line;
+    if (!connection.read_line(line)) throw std::runtime_error("aocd closed the connection");
+
+    std::istringstream reply(line);
+    std::string status;
+    reply >> status;
+    if (status == "error")
+    {
+        std::string message;
+        std::getline(reply >> std::ws, message);
+        throw std::runtime_error(message);
+    }
+
+    long long parse_us = 0, solve_us = 0;
+    int cached = 0;
+    size_t length = 0;
+    if (status != "ok" || !(reply >> parse_us >> solve_us >> cached >> length))
+    {
+        throw std::runtime_error("Bad reply from aocd: " + line);
+    }
+
+    std::cerr << std::fixed << std::setprecision(3) << what << ": " << solve_us / 1000.0 << "ms (";
+    if (cached) std::cerr << "input already parsed)" << std::endl;
+    else std::cerr << "parsed in " << parse_us / 1000.0 << "ms)" << std::endl;
+
+    return connection.read_bytes(length);
+}
+
+
+int main(int argc, char* argv[])
+{
+    std::string day;
+    std::vector<int> parts{1, 2};
+    std::string input = ".";
+    bool send_inline = false;
+    bool shutdown = false;
+    std::string socket_path = default_socket_path();
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--part" && has_value) parts = {std::atoi(argv[++i])};
+        else if (arg == "--input" && has_value) input = argv[++i];
+        else if (arg == "--inline") send_inline = true;
+        else if (arg == "--socket" && has_value) socket_path = argv[++i];
+        else if (arg == "--shutdown") shutdown = true;
+        else if (day.empty() && arg[0] != '-') day = arg;
+        else return usage();
+    }
+    if (day.empty() == !shutdown) return usage();
+
+    try
+    {
+        Connection connection(Connection::connect_to(socket_path));
+
+        if (shutdown)
+        {
+            std::string reply;
+            connection.write_all("shutdown\n");
+            connection.read_line(reply);
+            return 0;
+        }
+
+        // the daemon has its own working directory, so give it an absolute path
+        std::string request_input;
+        if (send_inline)
+        {
+            const std::string filename = std::filesystem::is_directory(input) ? input + "/input.txt" : input;
+            const std::string payload = read_file(filename);
+            request_input = "inline " + std::to_string(payload.size()) + "\n" + payload;
+        }
+        else
+        {
+            request_input = "path " + std::filesystem::absolute(input).string() + "\n";
+        }
+
+        // send all the requests together, then read the replies
+        for (int part : parts)
+        {
+            connection.write_all("solve " + day + " " + std::to_string(part) + " " + request_input);
+        }
+        for (int part : parts)
+        {
+            std::string answer = read_reply(connection, day + " part" + std::to_string(part));
+            if (!answer.empty()) std::cout << answer << std::endl;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "aoc: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
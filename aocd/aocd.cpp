@@ -0,0 +1,394 @@
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "protocol.h"
+#include "../aoc_all/all_days.h"
+#include "../util/batch.h"
+#include "../util/input_cache.h"
+
+#include "tbb/task_arena.h"
+
+// The solver daemon: every day linked into one long-lived process, listening on a Unix socket (see protocol.h),
+// so asking for an answer doesn't pay for starting a process, starting up TBB, or parsing an input again.
+//
+//     aocd [--socket <path>]
+//
+// Parsed inputs are kept (up to max_cached_inputs of them, dropping the least recently used) keyed by the day
+// and the input - its path and modification time, or a hash of an inline payload. Inline payloads, and inputs
+// given as a file rather than a directory, are put in a scratch directory as input.txt, since that's what
+// the days read. (Day 16 also reads input_instrs.txt, so it needs a directory.)
+// The days with their puzzle input built in (see Solver::reads_input) answer every request with an error.
+//
+// Any number of clients can be connected at once: their sockets are all watched with poll(), and a request is
+// only taken up once the whole of it (payload and all) has arrived, so a client that's idle, or slow to send,
+// doesn't hold anyone else up. A client that stops reading its replies is dropped after send_timeout_seconds.
+// Requests are solved one at a time, inside a TBB arena that's kept for the life of the daemon, so the days'
+// own parallel loops always have warm worker threads.
+//
+// If there's already a daemon answering on the socket, aocd won't start (rather than quietly taking the socket
+// over); a socket left behind by one that didn't shut down cleanly is replaced.
+
+namespace fs = std::filesystem;
+
+
+constexpr size_t max_cached_inputs = 64;
+constexpr int send_timeout_seconds = 10;
+
+
+// a connected client, and how far through its current request we've got
+struct Client
+{
+    std::unique_ptr<Connection> connection;
+    bool waiting_for_payload = false;   // the request line's been taken, but its payload hasn't all arrived
+    std::string request_line;
+};
+
+
+struct CachedInput
+{
+    std::unique_ptr<Solver> solver;
+    bool part1_done = false;    // some days solve part 2 along with part 1, so that has to have been run
+    uint64_t last_used = 0;
+};
+
+
+class Daemon
+{
+private:
+    fs::path scratch;
+    tbb::task_arena arena;
+    std::map<std::string, CachedInput> cache;
+    uint64_t requests = 0;
+
+    // the directory to parse for a path on this machine, and the key for caching what was parsed from it
+    std::string input_dir_for_path(const std::string& day_name, const std::string& path, std::string& key)
+    {
+        struct stat st{};
+        if (::stat(path.c_str(), &st) != 0) throw std::runtime_error("No such input: " + path);
+
+        const std::string canonical = fs::canonical(path).string();
+        std::string dir = canonical;
+        std::string input_file = canonical + "/input.txt";
+
+        if (!S_ISDIR(st.st_mode))
+        {
+            dir = link_input_file(canonical, scratch.string());
+            input_file = canonical;
+        }
+
+        // a missing or unreadable input is an error now, rather than an empty input for the day to parse
+        struct stat input_st{};
+        if (::stat(input_file.c_str(), &input_st) != 0) throw std::runtime_error("No such input: " + input_file);
+        if (!std::ifstream(input_file)) throw std::runtime_error("Failed to open " + input_file);
+
+        // if the input changes, it'll have a new modification time, and so miss the cache
+        const int64_t modified = static_cast<int64_t>(input_st.st_mtim.tv_sec) * 1000000000 + input_st.st_mtim.tv_nsec;
+
+        key = day_name + " path " + canonical + " " + std::to_string(modified);
+        return dir;
+    }
+
+    // the directory to parse for an inline payload (written out as input.txt), and its cache key
+    std::string input_dir_for_payload(const std::string& day_name, const std::string& payload, std::string& key)
+    {
+        const std::string hash = std::to_string(hash_bytes(payload));
+
+        fs::path dir = scratch / ("inline-" + hash);
+        if (!fs::exists(dir / "input.txt"))
+        {
+            fs::create_directories(dir);
+            std::ofstream f(dir / "input.txt", std::ios::binary);
+            f.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+            if (!f) throw std::runtime_error("Failed to write the payload to " + dir.string());
+        }
+
+        key = day_name + " inline " + hash + " " + std::to_string(payload.size());
+        return dir.string();
+    }
+
+    void evict_if_full()
+    {
+        if (cache.size() < max_cached_inputs) return;
+
+        auto oldest = cache.begin();
+        for (auto it = cache.begin(); it != cache.end(); ++it)
+        {
+            if (it->second.last_used < oldest->second.last_used) oldest = it;
+        }
+        cache.erase(oldest);
+    }
+
+    // solve one request, giving the reply to send back
+    std::string solve(const std::string& day_name, int part, const std::string& kind, const std::string& input)
+    {
+        typedef std::chrono::steady_clock clock;
+        auto microseconds_since = [](clock::time_point start) -> long long
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - start).count();
+        };
+
+        const DayEntry* day = find_day(day_name);
+        if (day == nullptr) throw std::runtime_error("Unknown day: " + day_name);
+        if (part != 1 && part != 2) throw std::runtime_error("Part must be 1 or 2");
+        if (!day->make_solver()->reads_input())
+        {
+            throw std::runtime_error("The puzzle input is built into " + day->name + ", so it can't solve other inputs");
+        }
+
+        std::string key;
+        const std::string dir = kind == "path" ? input_dir_for_path(day->name, input, key)
+                                               : input_dir_for_payload(day->name, input, key);
+
+        // parse the input, if we haven't already
+        long long parse_us = 0;
+        bool cached = true;
+        auto it = cache.find(key);
+        if (it == cache.end())
+        {
+            evict_if_full();
+
+            CachedInput entry;
+            entry.solver = day->make_solver();
+
+            const auto parse_start = clock::now();
+            arena.execute([&] { entry.solver->parse(dir); });
+            parse_us = microseconds_since(parse_start);
+
+            it = cache.emplace(key, std::move(entry)).first;
+            cached = false;
+        }
+        CachedInput& entry = it->second;
+        entry.last_used = ++requests;
+
+        // and solve it (part 2 includes part 1 the first time, for the days that solve both together)
+        std::string answer;
+        const auto solve_start = clock::now();
+        arena.execute([&]
+        {
+            if (part == 1 || !entry.part1_done) answer = entry.solver->part1();
+            if (part == 2) answer = entry.solver->part2();
+        });
+        const long long solve_us = microseconds_since(solve_start);
+        entry.part1_done = true;
+
+        std::ostringstream reply;
+        reply << "ok " << parse_us << " " << solve_us << " " << (cached ? 1 : 0) << " " << answer.size() << "\n" << answer;
+        return reply.str();
+    }
+
+public:
+    explicit Daemon(fs::path scratch_dir) : scratch(std::move(scratch_dir))
+    {
+        arena.initialize();
+    }
+
+    // answer every request from a client that's arrived in full, returning false if asked to shut down
+    bool serve(Client& client)
+    {
+        Connection& connection = *client.connection;
+        while (true)
+        {
+            std::string line;
+            if (client.waiting_for_payload) line = client.request_line;
+            else if (!connection.take_line(line)) return true;      // the rest hasn't arrived yet
+
+            std::istringstream request(line);
+            std::string command;
+            request >> command;
+
+            if (command == "shutdown")
+            {
+                connection.write_all("ok 0 0 0 0\n");
+                return false;
+            }
+
+            std::string reply;
+            try
+            {
+                std::string day_name, kind;
+                int part = 0;
+                if (command != "solve" || !(request >> day_name >> part >> kind))
+                {
+                    throw std::runtime_error("Bad request: " + line);
+                }
+
+                std::string input;
+                if (kind == "path")
+                {
+                    // the path is the rest of the line (so it can have spaces in it)
+                    std::getline(request >> std::ws, input);
+                }
+                else if (kind == "inline")
+                {
+                    size_t length = 0;
+                    if (!(request >> length)) throw std::runtime_error("Bad request: " + line);
+
+                    // come back for it once it's all here
+                    client.waiting_for_payload = !connection.take_bytes(length, input);
+                    if (client.waiting_for_payload)
+                    {
+                        client.request_line = line;
+                        return true;
+                    }
+                }
+                else
+                {
+                    throw std::runtime_error("Bad request: " + line);
+                }
+
+                reply = solve(day_name, part, kind, input);
+            }
+            catch (const std::exception& e)
+            {
+                // keep it to one line
+                std::string message = e.what();
+                for (char& c : message) if (c == '\n') c = ' ';
+                reply = "error " + message + "\n";
+            }
+
+            connection.write_all(reply);
+        }
+    }
+};
+
+
+// whether there's a daemon answering on a socket already
+bool daemon_listening(const std::string& socket_path)
+{
+    int s = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (s < 0) return false;
+
+    sockaddr_un address = socket_address(socket_path);
+    const bool connected = ::connect(s, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+    ::close(s);
+    return connected;
+}
+
+
+int main(int argc, char* argv[])
+{
+    std::string socket_path = default_socket_path();
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--socket") == 0 && i + 1 < argc) socket_path = argv[++i];
+        else
+        {
+            std::cerr << "usage: aocd [--socket <path>]" << std::endl;
+            return 1;
+        }
+    }
+
+    try
+    {
+        // a socket left behind by a daemon that didn't shut down cleanly would stop us binding, but one that's
+        // still answering belongs to a daemon that's still running (and anything else isn't ours to remove)
+        struct stat st{};
+        if (::lstat(socket_path.c_str(), &st) == 0)
+        {
+            if (!S_ISSOCK(st.st_mode)) throw std::runtime_error(socket_path + " is already there, and isn't a socket");
+            if (daemon_listening(socket_path)) throw std::runtime_error("aocd is already running on " + socket_path);
+            ::unlink(socket_path.c_str());
+        }
+
+        int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener < 0) throw std::runtime_error(std::string("Failed to create socket: ") + std::strerror(errno));
+
+        sockaddr_un address = socket_address(socket_path);
+        if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || ::listen(listener, 16) < 0)
+        {
+            throw std::runtime_error("Failed to listen on " + socket_path + ": " + std::strerror(errno));
+        }
+
+        char scratch_template[] = "/tmp/aocd.XXXXXX";
+        if (::mkdtemp(scratch_template) == nullptr) throw std::runtime_error("Failed to make a scratch directory");
+
+        std::cerr << "aocd: listening on " << socket_path << std::endl;
+
+        {
+            Daemon daemon(scratch_template);
+            std::map<int, Client> clients;     // by socket
+
+            bool running = true;
+            while (running)
+            {
+                // wait for a new client, or for something from one we've got
+                std::vector<pollfd> polled{{listener, POLLIN, 0}};
+                for (const auto& c : clients) polled.push_back({c.first, POLLIN, 0});
+
+                if (::poll(polled.data(), polled.size(), -1) < 0)
+                {
+                    if (errno == EINTR) continue;
+                    throw std::runtime_error(std::string("Failed to poll: ") + std::strerror(errno));
+                }
+
+                for (size_t i = 1; i < polled.size() && running; ++i)
+                {
+                    if (polled[i].revents == 0) continue;
+
+                    Client& client = clients[polled[i].fd];
+                    bool open = false;
+                    try
+                    {
+                        open = client.connection->receive();
+                        running = daemon.serve(client);
+                    }
+                    catch (const std::exception& e)
+                    {
+                        // just this client's problem (it went away part way through, most likely)
+                        std::cerr << "aocd: " << e.what() << std::endl;
+                        open = false;
+                    }
+                    if (!open) clients.erase(polled[i].fd);
+                }
+
+                if (polled[0].revents & POLLIN)
+                {
+                    int fd = ::accept(listener, nullptr, nullptr);
+                    if (fd < 0)
+                    {
+                        if (errno != EINTR && errno != ECONNABORTED)
+                        {
+                            throw std::runtime_error(std::string("Failed to accept a connection: ") + std::strerror(errno));
+                        }
+                        continue;
+                    }
+
+                    // don't let a client that never reads its replies stall everyone else for long
+                    timeval timeout{send_timeout_seconds, 0};
+                    ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+                    clients[fd].connection = std::make_unique<Connection>(fd);
+                }
+            }
+        }
+
+        ::close(listener);
+        ::unlink(socket_path.c_str());
+        fs::remove_all(scratch_template);
+        std::cerr << "aocd: shut down" << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "aocd: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,183 @@
+//
+// Created by wuggy on 17/10/26.
+//
+
+#ifndef AOC2018_PROTOCOL_H
+#define AOC2018_PROTOCOL_H
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// What aocd (the solver daemon) and aoc (its client) say to each other, over a Unix domain socket.
+//
+// A connection carries any number of requests, each answered in turn. Requests are a line, sometimes
+// followed by a payload of the length given in the line:
+//
+//     solve <day> <part> path <dir-or-file>\n              solve the input at an absolute path on the server
+//     solve <day> <part> inline <length>\n<payload>        solve the payload (the contents of an input.txt)
+//     shutdown\n                                           stop the daemon
+//
+// and the replies are
+//
+//     ok <parse-us> <solve-us> <cached> <length>\n<answer>
+//     error <message>\n
+//
+// where the times are in microseconds (parse is 0 when the parsed input was cached, and cached is 1),
+// and the answer is as the day would print it, which might run over several lines (day 10).
+
+
+// where the daemon listens, unless told otherwise: $AOCD_SOCKET, or a socket in /tmp for this user
+inline std::string default_socket_path()
+{
+    const char* env = std::getenv("AOCD_SOCKET");
+    if (env != nullptr && *env != '\0') return env;
+    return "/tmp/aocd-" + std::to_string(getuid()) + ".sock";
+}
+
+
+inline sockaddr_un socket_address(const std::string& path)
+{
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path)) throw std::runtime_error("Socket path is too long: " + path);
+
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    return address;
+}
+
+
+// one end of a connection, reading lines and payloads and writing replies
+class Connection
+{
+private:
+    int fd;
+    std::string buffered;   // read from the socket, but not yet used
+
+    // read some more into the buffer, returning false at the end of the stream
+    bool fill()
+    {
+        char chunk[4096];
+        ssize_t n;
+        do
+        {
+            n = ::read(fd, chunk, sizeof(chunk));
+        } while (n < 0 && errno == EINTR);
+
+        if (n < 0) throw std::runtime_error(std::string("Failed to read from socket: ") + std::strerror(errno));
+        buffered.append(chunk, static_cast<size_t>(n));
+        return n > 0;
+    }
+
+public:
+    explicit Connection(int socket_fd) : fd(socket_fd)
+    {
+    }
+
+    ~Connection()
+    {
+        ::close(fd);
+    }
+
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    // connect to a daemon's socket
+    static int connect_to(const std::string& path)
+    {
+        int s = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (s < 0) throw std::runtime_error(std::string("Failed to create socket: ") + std::strerror(errno));
+
+        sockaddr_un address = socket_address(path);
+        if (::connect(s, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+        {
+            const int e = errno;
+            ::close(s);
+            throw std::runtime_error("Failed to connect to " + path + " (is aocd running?): " + std::strerror(e));
+        }
+        return s;
+    }
+
+    int descriptor() const
+    {
+        return fd;
+    }
+
+    // For a server juggling several connections: read whatever has arrived, without waiting for more
+    // (so only once poll() says there's something to read), returning false if the other end has closed.
+    bool receive()
+    {
+        return fill();
+    }
+
+    // and then take a whole line (without its newline) or payload from what's been received, if it's all there
+    bool take_line(std::string& line)
+    {
+        size_t end = buffered.find('\n');
+        if (end == std::string::npos) return false;
+
+        line.assign(buffered, 0, end);
+        buffered.erase(0, end + 1);
+        return true;
+    }
+
+    bool take_bytes(size_t length, std::string& bytes)
+    {
+        if (buffered.size() < length) return false;
+
+        bytes = buffered.substr(0, length);
+        buffered.erase(0, length);
+        return true;
+    }
+
+    // the next line (without its newline), returning false if the stream ended first
+    bool read_line(std::string& line)
+    {
+        size_t end;
+        while ((end = buffered.find('\n')) == std::string::npos)
+        {
+            if (!fill())
+            {
+                if (!buffered.empty()) throw std::runtime_error("Connection closed part way through a line");
+                return false;
+            }
+        }
+
+        line.assign(buffered, 0, end);
+        buffered.erase(0, end + 1);
+        return true;
+    }
+
+    std::string read_bytes(size_t length)
+    {
+        while (buffered.size() < length)
+        {
+            if (!fill()) throw std::runtime_error("Connection closed part way through a payload");
+        }
+
+        std::string bytes = buffered.substr(0, length);
+        buffered.erase(0, length);
+        return bytes;
+    }
+
+    void write_all(const std::string& data)
+    {
+        size_t written = 0;
+        while (written < data.size())
+        {
+            ssize_t n = ::send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) throw std::runtime_error(std::string("Failed to write to socket: ") + std::strerror(errno));
+            written += static_cast<size_t>(n);
+        }
+    }
+};
+
+
+#endif //AOC2018_PROTOCOL_H
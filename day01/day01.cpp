@@ -1,19 +1,48 @@
+#include "day01.h"
+
 #include <iostream>
 #include <cassert>
 #include <functional>
 #include <numeric>
-#include <unordered_set>
 
+#include "../util/field_scanner.h"
 #include "../util/file_parsing.h"
+#include "../util/flat_hash.h"
+#include "../util/input_cache.h"
+#include "../util/line_stream.h"
+
+
+namespace day01
+{
 
 int day01_solve_part1(const std::vector<int>& numbers)
 {
     return std::accumulate(numbers.begin(), numbers.end(), 0);
 }
 
+// as above, but reading the numbers a line at a time, so the input never has to fit in memory
+int day01_solve_part1_stream(const std::string& filename)
+{
+    LineStream lines(filename);
+
+    int freq = 0;
+    std::string_view line;
+    while (lines.next(line))
+    {
+        int i = 0;
+        bool parsed = FieldScanner(line).integer(i);
+        assert(parsed);
+        (void)parsed;
+
+        freq += i;
+    }
+
+    return freq;
+}
+
 int day01_solve_part2(const std::vector<int>& numbers)
 {
-    std::unordered_set<int> freq_set;
+    FlatHashSet<int> freq_set;
     int freq = 0;
     while(true)
     {
@@ -27,19 +56,64 @@ int day01_solve_part2(const std::vector<int>& numbers)
 }
 
 
-int main()
+std::vector<int> load_numbers(const std::string& filename)
 {
-    auto file_text = read_file("input.txt");
-    assert(!file_text.empty());
+    MappedFile input(filename);
+    assert(!input.empty());
 
-    auto lines = parse_lines(file_text);
-    assert(!lines.empty());
+    return load_cached_records<int>(input.text(), "day01-numbers", 1, [&]
+    {
+        auto lines = parse_lines_view(input.text());
+        assert(!lines.empty());
+
+        return convert_strings<int>(lines, [](std::string_view s) -> int
+        { return std::stoi(std::string(s)); });
+    });
+}
 
-    std::vector<int> numbers = convert_strings<int>(lines, [](const std::string &s) -> int
-    { return std::stoi(s); });
 
-    std::cout << day01_solve_part1(numbers) << std::endl;
-    std::cout << day01_solve_part2(numbers) << std::endl;
-    return 0;
+class Day01Solver : public Solver
+{
+private:
+    std::string filename;
+    std::vector<int> numbers;
+    bool streamed = false;
+
+public:
+    void parse(const std::string& dir) override
+    {
+        filename = dir + "/input.txt";
+        numbers = load_numbers(filename);
+        streamed = false;
+    }
+
+    // part 1 reads the numbers as it goes
+    void parse_streamed(const std::string& dir) override
+    {
+        filename = dir + "/input.txt";
+        numbers.clear();
+        streamed = true;
+    }
+
+    std::string part1() override
+    {
+        if (streamed) return answer(day01_solve_part1_stream(filename));
+        return answer(day01_solve_part1(numbers));
+    }
+
+    // part 2 goes round the list again and again (and remembers every frequency on the way), so it has to hold
+    // the whole thing however the input's read
+    std::string part2() override
+    {
+        if (streamed) numbers = load_numbers(filename);
+        return answer(day01_solve_part2(numbers));
+    }
+};
+
+
+std::unique_ptr<Solver> make_solver()
+{
+    return std::make_unique<Day01Solver>();
 }
 
+}
@@ -0,0 +1,18 @@
+//
+// Created by wuggy on 17/10/26.
+//
+
+#ifndef AOC2018_DAY01_H
+#define AOC2018_DAY01_H
+
+#include <memory>
+
+#include "../util/solver.h"
+
+namespace day01
+{
+    std::unique_ptr<Solver> make_solver();
+}
+
+
+#endif //AOC2018_DAY01_H
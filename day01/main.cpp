@@ -0,0 +1,6 @@
+#include "day01.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day01", day01::make_solver, argc, argv);
+}
@@ -1,3 +1,5 @@
+#include "day02.h"
+
 #include <iostream>
 #include <cassert>
 #include <functional>
@@ -7,6 +9,8 @@
 #include "../util/file_parsing.h"
 
 
+namespace day02
+{
 
 int day02_solve_part1(const std::vector<std::string>& lines)
 {
@@ -68,16 +72,37 @@ std::string day02_solve_part2(const std::vector<std::string>& lines)
     return "";
 }
 
-int main()
+
+class Day02Solver : public Solver
 {
-    auto file_text = read_file("input.txt");
-    assert(!file_text.empty());
+private:
+    std::vector<std::string> lines;
+
+public:
+    void parse(const std::string& dir) override
+    {
+        auto file_text = read_file(dir + "/input.txt");
+        assert(!file_text.empty());
 
-    auto lines = parse_lines(file_text);
-    assert(!lines.empty() > 0);
+        lines = parse_lines(file_text);
+        assert(!lines.empty() > 0);
+    }
 
-    std::cout << day02_solve_part1(lines) << std::endl;
-    std::cout << day02_solve_part2(lines) << std::endl;
-    return 0;
+    std::string part1() override
+    {
+        return answer(day02_solve_part1(lines));
+    }
+
+    std::string part2() override
+    {
+        return day02_solve_part2(lines);
+    }
+};
+
+
+std::unique_ptr<Solver> make_solver()
+{
+    return std::make_unique<Day02Solver>();
 }
 
+}
@@ -0,0 +1,6 @@
+#include "day02.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day02", day02::make_solver, argc, argv);
+}
@@ -1,11 +1,20 @@
+#include "day03.h"
+
 #include <iostream>
 #include <cassert>
 #include <functional>
 #include <unordered_map>
-#include <sstream>
 #include <algorithm>
 
+#include "../util/disjoint_set.h"
 #include "../util/file_parsing.h"
+#include "../util/format_scan.h"
+#include "../util/input_cache.h"
+#include "../util/parallel_parsing.h"
+
+
+namespace day03
+{
 
 struct claim
 {
@@ -16,20 +25,20 @@ struct claim
     int height;
 };
 
-struct claim parse_claim(const std::string& line)
+static constexpr char claim_format[] = "#{} @ {},{}: {}x{}";
+
+// each tile of the fabric: how many claims are on it, and the first of them
+struct tile
 {
-    struct claim c = {};
-    std::stringstream ss(line);
+    int id = 0;
+    int count = 0;
+};
 
-    ss >> '#' >> c.id;
-    ss >> '@' >> c.x >> ',' >> c.y;
-    ss >> ':' >> c.width >> 'x' >> c.height;
+using Fabric = std::vector<std::vector<tile>>;
 
-    assert(ss);
-    return c;
-}
 
-std::pair<int, int> day03_solve_part1_and_2(const std::vector<struct claim>& claims)
+// lay all the claims on the fabric, counting the tiles with more than one claim on them
+int day03_solve_part1(const std::vector<struct claim>& claims, Fabric& grid)
 {
     // find the maxes
     auto max_x_iter = std::max_element(claims.begin(), claims.end(), [](const struct claim& a, const struct claim& b) -> bool { return a.x + a.width < b.x + b.width; });
@@ -38,21 +47,8 @@ std::pair<int, int> day03_solve_part1_and_2(const std::vector<struct claim>& cla
     auto max_y_iter = std::max_element(claims.begin(), claims.end(), [](const struct claim& a, const struct claim& b) -> bool { return a.y + a.height < b.y + b.height; });
     size_t max_height = max_y_iter->y + max_y_iter->height + 1;
 
-    size_t max_id = std::max_element(claims.begin(), claims.end(), [](const struct claim& a, const struct claim& b) -> bool { return a.id < b.id; })->id;
-
-    struct tile
-    {
-        int id = 0;
-        int count = 0;
-    };
-
     // make a grid
-    std::vector<std::vector<tile>> grid;
-    grid.resize(max_height);
-    for (auto& row : grid) row.resize(max_width, {});
-
-    std::vector<bool> overlapped;
-    overlapped.resize(max_id, false);
+    grid.assign(max_height, std::vector<tile>(max_width));
 
     // count on all the grid squares
     int overlapping = 0;
@@ -69,25 +65,38 @@ std::pair<int, int> day03_solve_part1_and_2(const std::vector<struct claim>& cla
                 if (t.count == 2) ++overlapping; // only count overlaps ONCE
 
                 // set the id if this is the first time claiming this tile
-                if (t.id)
-                {
-                    // this overlaps with something else
-                    // set both ourselves and the original as overlapped
-                    overlapped[t.id] = true;
-                    overlapped[c.id] = true;
-                }
-                else
-                {
-                    t.id = c.id;    // we're the first to use this tile
-                }
+                if (!t.id) t.id = c.id;
             }
         }
     }
 
-    // search for the first non-overlapping id
+    return overlapping;
+}
+
+// find the claim that overlaps nothing, from the fabric part 1 laid them all out on
+int day03_solve_part2(const std::vector<struct claim>& claims, const Fabric& grid)
+{
+    size_t max_id = std::max_element(claims.begin(), claims.end(), [](const struct claim& a, const struct claim& b) -> bool { return a.id < b.id; })->id;
+
+    // group the claims that overlap each other
+    DisjointSet overlapping_claims(max_id + 1);
     for (auto& c : claims)
     {
-        if (!overlapped[c.id]) return {overlapping, c.id};
+        for (size_t y = 0; y < c.height; ++y)
+        {
+            for (size_t x = 0; x < c.width; ++x)
+            {
+                // this overlaps with something else, so join ourselves with the first claim on the tile
+                const auto& t = grid[c.y + y][c.x + x];
+                if (t.count > 1) overlapping_claims.unite(t.id, c.id);
+            }
+        }
+    }
+
+    // search for the first non-overlapping id (in a group on its own)
+    for (auto& c : claims)
+    {
+        if (overlapping_claims.set_size(c.id) == 1) return c.id;
     }
 
     assert(false);  // no none overlapping region found?
@@ -95,19 +104,42 @@ std::pair<int, int> day03_solve_part1_and_2(const std::vector<struct claim>& cla
 }
 
 
-int main()
+class Day03Solver : public Solver
 {
-    auto file_text = read_file("input.txt");
-    assert(!file_text.empty());
+private:
+    std::vector<struct claim> claims;
+    Fabric grid;
+
+public:
+    void parse(const std::string& dir) override
+    {
+        MappedFile input(dir + "/input.txt");
+        assert(!input.empty());
+
+        claims = load_cached_records<struct claim>(input.text(), "day03-claims", 1, [&]
+        {
+            auto lines = parse_lines_view(input.text());
+            assert(!lines.empty() > 0);
 
-    auto lines = parse_lines(file_text);
-    assert(!lines.empty() > 0);
+            return convert_strings_parallel<struct claim>(lines, record_parser<claim_format>(&claim::id, &claim::x, &claim::y, &claim::width, &claim::height));
+        });
+    }
+
+    std::string part1() override
+    {
+        return answer(day03_solve_part1(claims, grid));
+    }
+
+    std::string part2() override
+    {
+        return answer(day03_solve_part2(claims, grid));
+    }
+};
 
-    auto claims = convert_strings<struct claim>(lines, parse_claim);
 
-    auto result = day03_solve_part1_and_2(claims);
-    std::cout << result.first << std::endl;
-    std::cout << result.second << std::endl;
-    return 0;
+std::unique_ptr<Solver> make_solver()
+{
+    return std::make_unique<Day03Solver>();
 }
 
+}
@@ -0,0 +1,6 @@
+#include "day03.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day03", day03::make_solver, argc, argv);
+}
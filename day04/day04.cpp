@@ -1,3 +1,5 @@
+#include "day04.h"
+
 #include <iostream>
 #include <cassert>
 #include <algorithm>
@@ -7,6 +9,10 @@
 
 #include "../util/file_parsing.h"
 
+
+namespace day04
+{
+
 enum guard_state
 {
     noGuard,
@@ -79,17 +85,27 @@ struct time_compare_events
 };
 
 
-std::pair<long, long> day04_solve_part1_and_2(const std::vector<event>& events)
+// how long each guard spent asleep, by guard and by minute
+struct guard_sleep_data
 {
-    // process the events so we know how long each guard spent asleep
-    struct guard_sleep_data
-    {
-        int sleep_count = 0;
-        std::array<int, 60> sleep_minutes = {};
-    };
+    int sleep_count = 0;
+    std::array<int, 60> sleep_minutes = {};
+};
 
+struct sleep_log
+{
     std::array<std::unordered_map<long, int>, 60> minute_sleepy_guards;
     std::unordered_map<long, struct guard_sleep_data> guard_sleepy_times;
+};
+
+
+// process the events so we know how long each guard spent asleep
+sleep_log tally_sleep(const std::vector<event>& events)
+{
+    sleep_log log;
+    auto& minute_sleepy_guards = log.minute_sleepy_guards;
+    auto& guard_sleepy_times = log.guard_sleepy_times;
+
     struct guard_sleep_data* current_guard_data = nullptr;
     long current_sleep_start = 0;
     guard_state current_state = noGuard;
@@ -141,11 +157,17 @@ std::pair<long, long> day04_solve_part1_and_2(const std::vector<event>& events)
         }
     }
 
+    return log;
+}
+
+
+long day04_solve_part1(const sleep_log& log)
+{
+    const auto& guard_sleepy_times = log.guard_sleepy_times;
 
-    // PART 1
     // find the guard with the most sleep
     auto max_guard_iter = std::max_element(guard_sleepy_times.begin(), guard_sleepy_times.end(),
-            [](const decltype(guard_sleepy_times)::value_type& a, const decltype(guard_sleepy_times)::value_type& b) -> bool
+            [](const decltype(sleep_log::guard_sleepy_times)::value_type& a, const decltype(sleep_log::guard_sleepy_times)::value_type& b) -> bool
             {
                 return a.second.sleep_count < b.second.sleep_count;
             });
@@ -155,9 +177,13 @@ std::pair<long, long> day04_solve_part1_and_2(const std::vector<event>& events)
     auto max_sleep_iter = std::max_element(sm.begin(), sm.end());
     long i = max_sleep_iter - sm.begin();
 
-    long part1_answer = max_guard_iter->first * i;
+    return max_guard_iter->first * i;
+}
+
+long day04_solve_part2(const sleep_log& log)
+{
+    const auto& minute_sleepy_guards = log.minute_sleepy_guards;
 
-    // PART 2
     // find the minute where some guard was most frequently asleep
     long most_sleepy_minute = 0;
     long most_sleepy_guard = 0;
@@ -175,25 +201,46 @@ std::pair<long, long> day04_solve_part1_and_2(const std::vector<event>& events)
         }
     }
 
-    long part2_answer = most_sleepy_minute * most_sleepy_guard;
-    return {part1_answer, part2_answer};
+    return most_sleepy_minute * most_sleepy_guard;
 }
 
-int main()
+
+class Day04Solver : public Solver
 {
-    auto file_text = read_file("input.txt");
-    assert(!file_text.empty());
+private:
+    std::vector<struct event> events;
+    sleep_log log;
+
+public:
+    void parse(const std::string& dir) override
+    {
+        auto file_text = read_file(dir + "/input.txt");
+        assert(!file_text.empty());
+
+        auto lines = parse_lines(file_text);
+        assert(!lines.empty() > 0);
+
+        event_line_parser p;
+        events = convert_strings<struct event>(lines, p);
+        std::sort(events.begin(), events.end(), time_compare_events());
+    }
 
-    auto lines = parse_lines(file_text);
-    assert(!lines.empty() > 0);
+    std::string part1() override
+    {
+        log = tally_sleep(events);
+        return answer(day04_solve_part1(log));
+    }
+
+    std::string part2() override
+    {
+        return answer(day04_solve_part2(log));
+    }
+};
 
-    event_line_parser p;
-    auto events = convert_strings<struct event>(lines, p);
-    std::sort(events.begin(), events.end(), time_compare_events());
 
-    auto result = day04_solve_part1_and_2(events);
-    std::cout << result.first << std::endl;
-    std::cout << result.second << std::endl;
-    return 0;
+std::unique_ptr<Solver> make_solver()
+{
+    return std::make_unique<Day04Solver>();
 }
 
+}
@@ -0,0 +1,18 @@
+//
+// Created by wuggy on 17/10/26.
+//
+
+#ifndef AOC2018_DAY04_H
+#define AOC2018_DAY04_H
+
+#include <memory>
+
+#include "../util/solver.h"
+
+namespace day04
+{
+    std::unique_ptr<Solver> make_solver();
+}
+
+
+#endif //AOC2018_DAY04_H
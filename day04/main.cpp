@@ -0,0 +1,6 @@
+#include "day04.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day04", day04::make_solver, argc, argv);
+}
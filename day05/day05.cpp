@@ -1,10 +1,18 @@
+#include "day05.h"
+
+#include <algorithm>
 #include <iostream>
 #include <cassert>
 #include <vector>
 #include <regex>
-#include <stack>
+#include <string>
 
 #include "../util/file_parsing.h"
+#include "../util/line_stream.h"
+
+
+namespace day05
+{
 
 bool are_opposites(char a, char b)
 {
@@ -15,58 +23,114 @@ bool are_opposites(char a, char b)
 }
 
 
-size_t collapse_polymer(const std::string& polymers, char ignore)
+// the polymer so far, after all the reactions, which can be fed one unit at a time
+class PolymerReactor
 {
-    std::stack<char> p;
+private:
+    std::string p;      // used as a stack, a byte per unit
+    char ignore;
+
+public:
+    explicit PolymerReactor(char ignore) : ignore(ignore) {}
 
-    for (char c : polymers)
+    void add(char c)
     {
-        if (ignore == tolower(c)) continue; // skip the ignore polymer
+        if (ignore == tolower(c)) return; // skip the ignore polymer
+
+
+        if (p.empty()) p.push_back(c);                      // nothing to react with
+        else if (are_opposites(c, p.back())) p.pop_back();  // did react with neighbour
+        else p.push_back(c);                                // didn't react
+    }
+
+    size_t size() const
+    {
+        return p.size();
+    }
+
+    const std::string& polymer() const
+    {
+        return p;
+    }
+};
+
+std::string collapse_polymer(const std::string& polymers, char ignore)
+{
+    PolymerReactor reactor(ignore);
+    for (char c : polymers) reactor.add(c);
+    return reactor.polymer();
+}
 
+// collapse the polymer in a file, in a single pass over it, without holding the uncollapsed polymer in memory
+// (only what's left after the reactions - which is still the whole thing for a polymer that doesn't react at all)
+std::string collapse_polymer_stream(const std::string& filename)
+{
+    PolymerReactor reactor(0);
 
-        if (p.empty()) p.push(c);                       // nothing to react with
-        else if (are_opposites(c, p.top())) p.pop();    // did react with neighbour
-        else p.push(c);                                 // didn't react
+    ChunkReader reader(filename);
+    for (auto chunk = reader.next(); !chunk.empty(); chunk = reader.next())
+    {
+        for (char c : chunk)
+        {
+            if (isspace(c)) continue;   // the trailing newline isn't part of the polymer
+            reactor.add(c);
+        }
     }
 
-    return p.size();
+    return reactor.polymer();
 }
 
-size_t day05_solve_part1(const std::string& polymers)
+size_t day05_solve_part1(const std::string& collapsed)
 {
-    return collapse_polymer(polymers, 0);
+    return collapsed.size();
 }
 
-size_t day05_solve_part2(const std::string& polymers)
+size_t day05_solve_part2(const std::string& collapsed)
 {
+    // removing a unit and then collapsing gives the same as collapsing, removing the unit, and collapsing again
+    // (the reactions that happened without it are still there to happen), so each of these only has to go
+    // over the polymer part 1 is left with - one at a time, so there's only ever one more copy of it around
     // only works in ascii
-    size_t smallest_size = polymers.size();
-    char smallest_ignored = ' ';
+    size_t smallest_size = collapsed.size();
 
     for(char c='a'; c <= 'z'; ++c)
     {
-        size_t this_size = collapse_polymer(polymers, c);
-        if (this_size < smallest_size)
-        {
-            smallest_size = this_size;
-            smallest_ignored = c;
-        }
+        smallest_size = std::min(smallest_size, collapse_polymer(collapsed, c).size());
     }
 
     return smallest_size;
 }
 
 
-int main()
+class Day05Solver : public Solver
 {
-    auto file_text = read_file("input.txt");
-    assert(!file_text.empty());
+private:
+    std::string filename;
+    std::string collapsed;
 
-    auto lines = parse_lines(file_text);
-    assert(lines.size() == 1);  // expect only 1 line!
+public:
+    // the polymer is streamed through as it's collapsed, so there's nothing to parse up front
+    void parse(const std::string& dir) override
+    {
+        filename = dir + "/input.txt";
+    }
 
-    std::cout << day05_solve_part1(lines[0]) << std::endl;
-    std::cout << day05_solve_part2(lines[0]) << std::endl;
-    return 0;
+    std::string part1() override
+    {
+        collapsed = collapse_polymer_stream(filename);
+        return answer(day05_solve_part1(collapsed));
+    }
+
+    std::string part2() override
+    {
+        return answer(day05_solve_part2(collapsed));
+    }
+};
+
+
+std::unique_ptr<Solver> make_solver()
+{
+    return std::make_unique<Day05Solver>();
 }
 
+}
@@ -0,0 +1,6 @@
+#include "day05.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day05", day05::make_solver, argc, argv);
+}
@@ -1,32 +1,39 @@
+#include "day06.h"
+
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <fstream>
 #include <iostream>
-#include <sstream>
+#include <stdexcept>
 #include <vector>
 
 #include "../util/file_parsing.h"
+#include "../util/format_scan.h"
+#include "../util/input_cache.h"
+#include "../util/parallel_parsing.h"
+#include "../util/point.h"
+#include "../util/spatial_index.h"
+#include "../util/trace.h"
 
 #include "tbb/blocked_range2d.h"
 #include "tbb/parallel_reduce.h"
 
-struct point
+
+namespace day06
 {
-    int x = 0;
-    int y = 0;
 
-    point() = default;
-    point(int ax, int ay) : x(ax), y(ay) {}
-};
+using point = PointN<2, int>;    // {x, y}
+using PointSet = PointsSoA<2, int>;
 
-struct point parse_point(const std::string& s)
-{
-    std::stringstream ss(s);
-    struct point p;
+static constexpr char point_format[] = "{}, {}";
 
-    ss >> p.x >> ',' >> p.y;
-    assert(ss);
+point parse_point(std::string_view s)
+{
+    point p;
+    scan_or_throw<point_format>(s, p[0], p[1]);
     return p;
-};
+}
 
 struct region
 {
@@ -42,75 +49,53 @@ struct region
         assert(height > 0);
     }
 
-    bool includes(const struct point& p) const
+    bool includes(const point& p) const
     {
-        return (p.x >= x) && (p.y >= y) && (p.x < x + width) && (p.y < y + height);
+        return (p[0] >= x) && (p[1] >= y) && (p[0] < x + width) && (p[1] < y + height);
     }
 
-    bool excludes(const struct point& p) const
+    bool excludes(const point& p) const
     {
-        return (p.x < x) || (p.y < y) || (p.x >= x + width) || (p.y >= y + height);
+        return (p[0] < x) || (p[1] < y) || (p[0] >= x + width) || (p[1] >= y + height);
     }
 };
 
 
-int dist(const point& a, const point& b)
-{
-    // manhattan distance
-    return abs(a.x - b.x) + abs(a.y - b.y);
-}
-
-int nearest_point_index(const std::vector<struct point>& points, const point& p)
+int nearest_point_index(const L1KdTree<2, int>& points, const point& p)
 {
     // returns the index of the nearest point, or -1 if there is no nearest point (i.e. two nearest points are equidistant)
-    int best_dist = dist(points[0], p);
-    int best_index = 0;
-    bool is_unique = true;  // if another dist is the same as best_dist, then this will be made false!
-
-    for (int i=1; i<points.size(); ++i)
-    {
-        int d = dist(points[i], p);
-        if (d < best_dist)
-        {
-            is_unique = true;
-            best_dist = d;
-            best_index = i;
-        }
-        else if (d == best_dist)
-        {
-            is_unique = false;
-        }
-    }
-
-    return is_unique ? best_index : -1;
+    auto nearest = points.nearest(p);
+    return nearest.unique ? static_cast<int>(nearest.index) : -1;
 }
 
-struct region find_bounds(const std::vector<struct point>& points)
+struct region find_bounds(const std::vector<point>& points)
 {
-    auto minmax_x = std::minmax_element(points.begin(), points.end(), [](const struct point& a, const struct point& b) -> bool { return a.x < b.x; });
-    auto minmax_y = std::minmax_element(points.begin(), points.end(), [](const struct point& a, const struct point& b) -> bool { return a.y < b.y; });
+    auto minmax_x = std::minmax_element(points.begin(), points.end(), [](const point& a, const point& b) -> bool { return a[0] < b[0]; });
+    auto minmax_y = std::minmax_element(points.begin(), points.end(), [](const point& a, const point& b) -> bool { return a[1] < b[1]; });
 
-    return {minmax_x.first->x,
-            minmax_y.first->y,
-            minmax_x.second->x - minmax_x.first->x + 1,
-            minmax_y.second->y - minmax_y.first->y + 1};
+    return {(*minmax_x.first)[0],
+            (*minmax_y.first)[1],
+            (*minmax_x.second)[0] - (*minmax_x.first)[0] + 1,
+            (*minmax_y.second)[1] - (*minmax_y.first)[1] + 1};
 };
 
 
-int day06_solve_part1(const std::vector<struct point>& points)
+int day06_solve_part1(const std::vector<point>& points)
 {
     // find the bounds of the points with a smaller border
     auto inner_bound = find_bounds(points);
     struct region outer_bound = {inner_bound.x - 1, inner_bound.y - 1, inner_bound.width + 2, inner_bound.height + 2};
 
+    const L1KdTree<2, int> point_tree(points);
+
     struct kernel
     {
         std::vector<int> region_count;
 
-        const std::vector<struct point>& points;
+        const L1KdTree<2, int>& points;
         const struct region& inner_bound;
 
-        kernel(const std::vector<struct point>& p, const struct region& i) : points(p), inner_bound(i)
+        kernel(const L1KdTree<2, int>& p, const struct region& i) : points(p), inner_bound(i)
         {
             region_count.resize(points.size(), 0);
         }
@@ -122,11 +107,12 @@ int day06_solve_part1(const std::vector<struct point>& points)
 
         void operator()(const tbb::blocked_range2d<int, int>& range)
         {
+            AOC_TRACE_SCOPE("region chunk");
             for (int y = range.rows().begin() ; y < range.rows().end() ; ++y)
             {
                 for (int x = range.cols().begin() ; x < range.cols().end() ; ++x)
                 {
-                    struct point this_point(x, y);
+                    const point this_point{{x, y}};
 
                     //!! part 1 solver
                     // for this point, determine which is the nearest point in points
@@ -158,7 +144,7 @@ int day06_solve_part1(const std::vector<struct point>& points)
 
     };
 
-    struct kernel k(points, inner_bound);
+    struct kernel k(point_tree, inner_bound);
     tbb::parallel_reduce(
             tbb::blocked_range2d<int, int>(outer_bound.y, outer_bound.y + outer_bound.height, outer_bound.x, outer_bound.x + outer_bound.width),
             k);
@@ -167,32 +153,41 @@ int day06_solve_part1(const std::vector<struct point>& points)
     return largest_area;
 }
 
-int day06_solve_part2(const std::vector<struct point>& points)
+// the puzzle's threshold on the total distance for part 2 (gen's bigger inputs give a bigger one, in
+// input_max_distance.txt, since the sums to their more spread out points grow with them)
+constexpr int64_t default_max_total_distance = 10000;
+
+int day06_solve_part2(const std::vector<point>& points, int64_t max_total_distance)
 {
     // find the bounds of the points with a larger border!
     // this function will assert if the border wasn't big enough
 
 
     auto points_bound = find_bounds(points);
-    int border = (2 * 10000) / static_cast<int>(points.size());   // estimate the maximum extent of the region
-    struct region inner_bound = {inner_bound.x - border, inner_bound.y - border, inner_bound.width + (2 * border), inner_bound.height + (2 * border)};
+    // estimate the maximum extent of the region
+    int border = static_cast<int>((2 * max_total_distance) / static_cast<int64_t>(points.size()));
+    struct region inner_bound = {points_bound.x - border, points_bound.y - border, points_bound.width + (2 * border), points_bound.height + (2 * border)};
     struct region outer_bound = {inner_bound.x - 1, inner_bound.y - 1, inner_bound.width + 2, inner_bound.height + 2};
 
+    const PointSet point_set(points);
+
     struct kernel
     {
         int region_count;
         bool hit_boundry;
+        std::vector<int> dists;     // scratch space for the distances to each point
 
-        const std::vector<struct point>& points;
+        const PointSet& points;
         const struct region& inner_bound;
+        int64_t max_total_distance;
 
-        kernel(const std::vector<struct point>& p, const struct region& i) : points(p), inner_bound(i)
+        kernel(const PointSet& p, const struct region& i, int64_t m) : points(p), inner_bound(i), max_total_distance(m)
         {
             region_count = 0;
             hit_boundry = false;
         }
 
-        kernel(kernel& o, tbb::split) : points(o.points), inner_bound(o.inner_bound)
+        kernel(kernel& o, tbb::split) : points(o.points), inner_bound(o.inner_bound), max_total_distance(o.max_total_distance)
         {
             region_count = 0;
             hit_boundry = false;
@@ -200,17 +195,19 @@ int day06_solve_part2(const std::vector<struct point>& points)
 
         void operator()(const tbb::blocked_range2d<int, int>& range)
         {
+            AOC_TRACE_SCOPE("region chunk");
             for (int y = range.rows().begin() ; y < range.rows().end() ; ++y)
             {
                 for (int x = range.cols().begin() ; x < range.cols().end() ; ++x)
                 {
-                    struct point this_point(x, y);
+                    const point this_point{{x, y}};
 
                     //!! part 2 solver
                     // compute the sum of the distances to this point, and check it's under the threshold
-                    int dist_sum = 0;
-                    for (auto& p : points) dist_sum += dist(p, this_point);
-                    if (dist_sum < 10000)
+                    distances(this_point, points, dists);
+                    int64_t dist_sum = 0;
+                    for (int d : dists) dist_sum += d;
+                    if (dist_sum < max_total_distance)
                     {
                         ++region_count;
 
@@ -229,7 +226,7 @@ int day06_solve_part2(const std::vector<struct point>& points)
 
     };
 
-    struct kernel k(points, inner_bound);
+    struct kernel k(point_set, inner_bound, max_total_distance);
     tbb::parallel_reduce(
             tbb::blocked_range2d<int, int>(outer_bound.y, outer_bound.y + outer_bound.height, outer_bound.x, outer_bound.x + outer_bound.width),
             k);
@@ -239,18 +236,50 @@ int day06_solve_part2(const std::vector<struct point>& points)
 }
 
 
-int main()
+class Day06Solver : public Solver
 {
-    auto file_text = read_file("input.txt");
-    assert(!file_text.empty());
+private:
+    std::vector<point> points;
+    int64_t max_total_distance = default_max_total_distance;
+
+public:
+    void parse(const std::string& dir) override
+    {
+        MappedFile input(dir + "/input.txt");
+        assert(!input.empty());
+
+        points = load_cached_records<point>(input.text(), "day06-points", 1, [&]
+        {
+            auto lines = parse_lines_view(input.text());
+            assert(lines.size() > 0);
+
+            return convert_strings_parallel<point>(lines, parse_point);
+        });
+
+        // the real puzzle's threshold, unless the input came with its own
+        max_total_distance = default_max_total_distance;
+        std::ifstream threshold_input(dir + "/input_max_distance.txt");
+        if (threshold_input && !(threshold_input >> max_total_distance))
+        {
+            throw std::runtime_error("Bad threshold in " + dir + "/input_max_distance.txt");
+        }
+    }
+
+    std::string part1() override
+    {
+        return answer(day06_solve_part1(points));
+    }
 
-    auto lines = parse_lines(file_text);
-    assert(lines.size() > 0);
+    std::string part2() override
+    {
+        return answer(day06_solve_part2(points, max_total_distance));
+    }
+};
 
-    auto points = convert_strings<struct point>(lines, parse_point);
 
-    std::cout << day06_solve_part1(points) << std::endl;
-    std::cout << day06_solve_part2(points) << std::endl;
-    return 0;
+std::unique_ptr<Solver> make_solver()
+{
+    return std::make_unique<Day06Solver>();
 }
 
+}
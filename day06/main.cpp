@@ -0,0 +1,6 @@
+#include "day06.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day06", day06::make_solver, argc, argv);
+}
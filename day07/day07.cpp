@@ -1,12 +1,19 @@
+#include "day07.h"
+
 #include <algorithm>
 #include <array>
 #include <cassert>
 #include <iostream>
-#include <sstream>
+#include <limits>
 #include <unordered_map>
 #include <vector>
 
 #include "../util/file_parsing.h"
+#include "../util/format_scan.h"
+
+
+namespace day07
+{
 
 struct task_set
 {
@@ -200,29 +207,49 @@ int day07_solve_part2(std::unordered_map<char, task_set> dependencies)
     return time;
 }
 
-int main()
-{
-    auto file_text = read_file("input.txt");
-    assert(!file_text.empty());
+static constexpr char step_format[] = "Step {} must be finished before step {} can begin.";
 
-    auto lines = parse_lines(file_text);
-    assert(!lines.empty() > 0);
 
+class Day07Solver : public Solver
+{
+private:
     std::unordered_map<char, task_set> dependencies;
-    for (const auto& s : lines)
+
+public:
+    void parse(const std::string& dir) override
     {
-        std::stringstream ss(s);
+        MappedFile input(dir + "/input.txt");
+        assert(!input.empty());
+
+        auto lines = parse_lines_view(input.text());
+        assert(!lines.empty() > 0);
+
+        dependencies.clear();
+        for (const auto& s : lines)
+        {
+            char pretask = 0, posttask = 0;
+            scan_or_throw<step_format>(s, pretask, posttask);
 
-        char pretask = 0, posttask = 0;
-        ss >> "Step" >> pretask >> "must" >> "be" >> "finished" >> "before" >> "step" >> posttask >> "can" >> "begin.";
-        assert(ss);
+            dependencies[pretask];  // access but do not use - ensures it exists!
+            dependencies[posttask].set(pretask);
+        }
+    }
+
+    std::string part1() override
+    {
+        return day07_solve_part1(dependencies);
+    }
 
-        dependencies[pretask];  // access but do not use - ensures it exists!
-        dependencies[posttask].set(pretask);
+    std::string part2() override
+    {
+        return answer(day07_solve_part2(dependencies));
     }
+};
+
 
-    std::cout << day07_solve_part1(dependencies) << std::endl;
-    std::cout << day07_solve_part2(dependencies) << std::endl;
-    return 0;
+std::unique_ptr<Solver> make_solver()
+{
+    return std::make_unique<Day07Solver>();
 }
 
+}
@@ -0,0 +1,6 @@
+#include "day07.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day07", day07::make_solver, argc, argv);
+}
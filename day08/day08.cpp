@@ -1,9 +1,17 @@
+#include "day08.h"
+
 #include <cassert>
 #include <iostream>
 #include <functional>
 
+#include "../util/field_scanner.h"
 #include "../util/file_parsing.h"
+#include "../util/input_cache.h"
+#include "../util/line_stream.h"
+
 
+namespace day08
+{
 
 using Iter = std::vector<int>::const_iterator;
 
@@ -33,6 +41,42 @@ std::pair<Iter, int> sum_metadata(Iter left, Iter limit)
     return {left, metadata};
 }
 
+int next_number(TokenStream& tokens)
+{
+    std::string_view token;
+    bool read = tokens.next(token);
+    assert(read);
+
+    int n = 0;
+    bool parsed = read && FieldScanner(token).integer(n);
+    assert(parsed);
+    (void)parsed;
+
+    return n;
+}
+
+// as above, but pulling the numbers from a stream as the tree is walked, so only the path to the current node is held
+int sum_metadata(TokenStream& tokens)
+{
+    // extract the data for this node
+    int n_children = next_number(tokens);
+    int n_metadata = next_number(tokens);
+
+    int metadata = 0;
+    for(int i=0; i < n_children; i++)
+    {
+        metadata += sum_metadata(tokens);
+    }
+
+    // now add our metadata
+    for(int i=0; i<n_metadata; i++)
+    {
+        metadata += next_number(tokens);
+    }
+
+    return metadata;
+}
+
 std::pair<Iter, int> compute_value(Iter left, Iter limit)
 {
     assert(left < limit);
@@ -78,6 +122,47 @@ std::pair<Iter, int> compute_value(Iter left, Iter limit)
 }
 
 
+// as compute_value, but pulling the numbers from a stream, so only the path to the current node (and the values
+// of the children of each node on it) is held
+int compute_value(TokenStream& tokens)
+{
+    // extract the data for this node
+    int n_children = next_number(tokens);
+    int n_metadata = next_number(tokens);
+
+    // if we have no children, then our value is the sum of our metadata
+    if (n_children == 0)
+    {
+        int value = 0;
+        for(int i=0; i < n_metadata; i++)
+        {
+            value += next_number(tokens);
+        }
+
+        return value;
+    }
+
+    std::vector<int> child_values;
+    child_values.push_back(0);  // the 'zero-index' child has a value of zero
+
+    for(int i=0; i < n_children; i++)
+    {
+        child_values.push_back(compute_value(tokens));
+    }
+
+    // now index our childs values with our metadata
+    int value = 0;
+    for(int i=0; i<n_metadata; i++)
+    {
+        int index = next_number(tokens);
+        if (index < 0 || index >= static_cast<int>(child_values.size())) continue; // skip out of range indices
+        else value += child_values[index];
+    }
+
+    return value;
+}
+
+
 int day08_solve_part1(const std::vector<int>& numbers)
 {
     auto root = sum_metadata(numbers.begin(), numbers.end());
@@ -85,6 +170,18 @@ int day08_solve_part1(const std::vector<int>& numbers)
     return root.second;
 }
 
+int day08_solve_part1_stream(const std::string& filename)
+{
+    TokenStream tokens(filename);
+    int metadata = sum_metadata(tokens);
+
+    std::string_view trailing;
+    assert(!tokens.next(trailing));    // root should span all the numbers
+    (void)trailing;
+
+    return metadata;
+}
+
 int day08_solve_part2(const std::vector<int>& numbers)
 {
     auto root = compute_value(numbers.begin(), numbers.end());
@@ -92,22 +189,73 @@ int day08_solve_part2(const std::vector<int>& numbers)
     return root.second;
 }
 
-int main()
+int day08_solve_part2_stream(const std::string& filename)
+{
+    TokenStream tokens(filename);
+    int value = compute_value(tokens);
+
+    std::string_view trailing;
+    assert(!tokens.next(trailing));    // root should span all the numbers
+    (void)trailing;
+
+    return value;
+}
+
+
+class Day08Solver : public Solver
 {
-    auto file_text = read_file("input.txt");
-    assert(!file_text.empty());
+private:
+    std::string filename;
+    std::vector<int> numbers;
+    bool streamed = false;
+
+public:
+    void parse(const std::string& dir) override
+    {
+        filename = dir + "/input.txt";
+        streamed = false;
+
+        MappedFile input(filename);
+        assert(!input.empty());
+
+        numbers = load_cached_records<int>(input.text(), "day08-numbers", 1, [&]
+        {
+            auto lines = parse_lines_view(input.text());
+            assert(lines.size() == 1);  // expect exactly 1 line of input
+
+            auto fields = split_string_view(lines[0], ' ');
+            assert(!fields.empty());
+
+            return convert_strings<int>(fields, [](std::string_view s) -> int
+            { return std::stoi(std::string(s)); });
+        });
+    }
 
-    auto lines = parse_lines(file_text);
-    assert(lines.size() == 1);  // expect exactly 1 line of input
+    // both parts walk the tree straight from the file
+    void parse_streamed(const std::string& dir) override
+    {
+        filename = dir + "/input.txt";
+        numbers.clear();
+        streamed = true;
+    }
+
+    std::string part1() override
+    {
+        if (streamed) return answer(day08_solve_part1_stream(filename));
+        return answer(day08_solve_part1(numbers));
+    }
 
-    auto fields = split_string(lines[0], ' ');
-    assert(!fields.empty());
+    std::string part2() override
+    {
+        if (streamed) return answer(day08_solve_part2_stream(filename));
+        return answer(day08_solve_part2(numbers));
+    }
+};
 
-    std::vector<int> numbers = convert_strings<int>(fields, [](const std::string &s) -> int
-    { return std::stoi(s); });
 
-    std::cout << day08_solve_part1(numbers) << std::endl;
-    std::cout << day08_solve_part2(numbers) << std::endl;
-    return 0;
+std::unique_ptr<Solver> make_solver()
+{
+    return std::make_unique<Day08Solver>();
 }
 
+}
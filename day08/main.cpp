@@ -0,0 +1,6 @@
+#include "day08.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day08", day08::make_solver, argc, argv);
+}
@@ -1,3 +1,5 @@
+#include "day09.h"
+
 #include <cassert>
 #include <iostream>
 #include <functional>
@@ -6,6 +8,10 @@
 
 #include "../util/file_parsing.h"
 
+
+namespace day09
+{
+
 typedef long marble_value;
 
 class MarbleCircle
@@ -90,7 +96,6 @@ public:
 };
 
 
-
 marble_value day08_solve_part1(size_t n_players, marble_value last_marble_score)
 {
     MarbleCircle circle;
@@ -132,12 +137,37 @@ void test()
     assert(day08_solve_part1(30, 5807) == 37305);
 }
 
-int main()
+
+class Day09Solver : public Solver
 {
-    test();
+public:
+    // the puzzle input is in the source, so there's no input directory to read
+    bool reads_input() const override
+    {
+        return false;
+    }
+
+    // no input to read, but check the examples still work
+    void parse(const std::string&) override
+    {
+        test();
+    }
+
+    std::string part1() override
+    {
+        return answer(day08_solve_part1(493, 71863));
+    }
 
-    std::cout << day08_solve_part1(493, 71863) << std::endl;
-    std::cout << day08_solve_part1(493, 7186300) << std::endl;
-    return 0;
+    std::string part2() override
+    {
+        return answer(day08_solve_part1(493, 7186300));
+    }
+};
+
+
+std::unique_ptr<Solver> make_solver()
+{
+    return std::make_unique<Day09Solver>();
 }
 
+}
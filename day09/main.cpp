@@ -0,0 +1,6 @@
+#include "day09.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day09", day09::make_solver, argc, argv);
+}
@@ -1,3 +1,5 @@
+#include "day10.h"
+
 #include <cassert>
 #include <functional>
 #include <iostream>
@@ -6,7 +8,12 @@
 #include <limits>
 
 #include "../util/file_parsing.h"
+#include "../util/format_scan.h"
+#include "../util/input_cache.h"
+
 
+namespace day10
+{
 
 struct particle
 {
@@ -17,15 +24,7 @@ struct particle
     int dy = 0;
 };
 
-struct particle parse_particle(const std::string& s)
-{
-    struct particle p;
-
-    std::stringstream ss(s);
-    ss >> "position=<" >> p.x >> ',' >> p.y >> '>' >> "velocity=<" >> p.dx >> ',' >> p.dy >> '>';
-    assert(ss);
-    return p;
-}
+static constexpr char particle_format[] = "position=<{},{}> velocity=<{},{}>";
 
 
 int compute_score(const std::vector<struct particle>& particles_t0, int time)
@@ -63,8 +62,8 @@ std::string make_grid(const std::vector<struct particle>& particles_t0, int time
         assert(yt >= 0);
 
         // set the point in the grid for this position
-        if (grid.size() < yt) grid.resize(yt+1);
-        if (grid[yt].size() < xt) grid[yt].resize(xt+1, ' ');
+        if (grid.size() <= size_t(yt)) grid.resize(yt+1);
+        if (grid[yt].size() <= size_t(xt)) grid[yt].resize(xt+1, ' ');
         grid[yt][xt] = '#';
     }
 
@@ -135,20 +134,50 @@ std::pair<std::string, int> day10_solve_part1_and_2(const std::vector<struct par
    return {make_grid(particles_t0, left_bound), left_bound};
 }
 
-int main()
+
+class Day10Solver : public Solver
 {
-    auto file_text = read_file("input.txt");
-    assert(!file_text.empty());
+private:
+    std::vector<struct particle> particles_t0;
+    std::pair<std::string, int> answers;
+
+public:
+    void parse(const std::string& dir) override
+    {
+        MappedFile input(dir + "/input.txt");
+        assert(!input.empty());
+
+        particles_t0 = load_cached_records<struct particle>(input.text(), "day10-particles", 1, [&]
+        {
+            auto lines = parse_lines_view(input.text());
+            assert(!lines.empty());
+
+            return convert_strings<struct particle>(lines, record_parser<particle_format>(&particle::x, &particle::y, &particle::dx, &particle::dy));
+        });
+        assert(!particles_t0.empty());
+    }
+
+    std::string part1() override
+    {
+        answers = day10_solve_part1_and_2(particles_t0);
+        return answers.first;
+    }
+
+    std::string part2() override
+    {
+        return answer(answers.second);
+    }
 
-    auto lines = parse_lines(file_text);
-    assert(!lines.empty());
+    bool solves_parts_together() const override
+    {
+        return true;
+    }
+};
 
-    auto particles_t0 = convert_strings<struct particle>(lines, parse_particle);
-    assert(!particles_t0.empty());
 
-    auto result = day10_solve_part1_and_2(particles_t0);
-    std::cout << result.first << std::endl;
-    std::cout << result.second << std::endl;
-    return 0;
+std::unique_ptr<Solver> make_solver()
+{
+    return std::make_unique<Day10Solver>();
 }
 
+}
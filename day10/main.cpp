@@ -0,0 +1,6 @@
+#include "day10.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day10", day10::make_solver, argc, argv);
+}
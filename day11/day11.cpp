@@ -1,3 +1,5 @@
+#include "day11.h"
+
 #include <algorithm>
 #include <cassert>
 #include <iostream>
@@ -5,10 +7,15 @@
 #include <sstream>
 #include <tuple>
 
+#include "../util/trace.h"
+
 #include "tbb/blocked_range3d.h"
 #include "tbb/parallel_reduce.h"
 
 
+namespace day11
+{
+
 struct kernel
 {
     static constexpr int width = 300;
@@ -75,6 +82,8 @@ struct kernel
 
     void operator()(const tbb::blocked_range3d<int, int>& range)
     {
+        AOC_TRACE_SCOPE("square chunk");
+
         for (int y = range.rows().begin() ; y < range.rows().end() ; ++y)
         {
             for (int x = range.cols().begin() ; x < range.cols().end() ; ++x)
@@ -128,7 +137,6 @@ struct kernel
 };
 
 
-
 std::pair<int, int> day11_solve_part1(int grid_serial)
 {
 
@@ -159,16 +167,39 @@ std::tuple<int, int, int> day11_solve_part2(int grid_serial)
 }
 
 
-int main()
+class Day11Solver : public Solver
 {
-    const int grid_serial = 8979;
+private:
+    static constexpr int grid_serial = 8979;
+
+public:
+    // the puzzle input is in the source, so there's no input directory to read
+    bool reads_input() const override
+    {
+        return false;
+    }
+
+    void parse(const std::string&) override
+    {
+    }
+
+    std::string part1() override
+    {
+        auto result = day11_solve_part1(grid_serial);
+        return answer(result.first) + "," + answer(result.second);
+    }
 
-    auto result_part1 = day11_solve_part1(grid_serial);
-    std::cout << result_part1.first << "," << result_part1.second << std::endl;
+    std::string part2() override
+    {
+        auto result = day11_solve_part2(grid_serial);
+        return answer(std::get<0>(result)) + "," + answer(std::get<1>(result)) + "," + answer(std::get<2>(result));
+    }
+};
 
-    auto result_part2 = day11_solve_part2(grid_serial);
-    std::cout << std::get<0>(result_part2) << "," << std::get<1>(result_part2) << "," << std::get<2>(result_part2) << std::endl;
 
-    return 0;
+std::unique_ptr<Solver> make_solver()
+{
+    return std::make_unique<Day11Solver>();
 }
 
+}
@@ -0,0 +1,6 @@
+#include "day11.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day11", day11::make_solver, argc, argv);
+}
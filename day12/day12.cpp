@@ -1,21 +1,34 @@
+#include "day12.h"
+
 #include <array>
 #include <cassert>
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <limits>
-#include <sstream>
+#include <stdexcept>
+#include <string>
 #include <string_view>
 #include <vector>
-#include <unordered_map>
 
+#include "../util/cycle.h"
 #include "../util/file_parsing.h"
+#include "../util/flat_hash.h"
+#include "../util/format_scan.h"
+#include "../util/hash.h"
+#include "../util/trace.h"
+
+
+namespace day12
+{
 
 constexpr size_t expected_rule_len = 5;
 
 using RuleVal = int;
-using RuleSet = std::unordered_map<RuleVal, char>;
+using RuleSet = FlatHashMap<RuleVal, char>;
 
 
-RuleVal rule_from_string(const std::string& s)
+RuleVal rule_from_string(std::string_view s)
 {
     assert(s.size() == expected_rule_len);
 
@@ -31,7 +44,7 @@ RuleVal rule_from_string(const std::string& s)
 class PotSet
 {
 public:
-    typedef std::unordered_map<int, char> container_type;
+    typedef FlatHashMap<int, char> container_type;
 
 private:
     container_type potset;
@@ -59,6 +72,11 @@ public:
     container_type::iterator end() { return potset.end(); }
     container_type::const_iterator end() const { return potset.end(); }
 
+    size_t size() const
+    {
+        return potset.size();
+    }
+
     int min() const
     {
         return minval;
@@ -77,12 +95,14 @@ public:
     // convert the pot state to a pile of bits, ignoring the shift for the zero position
     std::vector<bool> to_bits() const
     {
+        AOC_TRACE_SCOPE("to_bits");
+
         std::vector<bool> v;
         for (const auto& kv : potset)
         {
             auto i = static_cast<size_t>(kv.first - minval);
 
-            if (v.size() < i) v.resize(i, false);
+            if (v.size() <= i) v.resize(i + 1, false);
             v[i] = true;
         }
 
@@ -91,14 +111,13 @@ public:
 };
 
 
-PotSet parse_initial_state(const std::string& s)
-{
-    std::stringstream ss(s);
-
-    std::string state;
-    ss >> "initial" >> "state:" >> state;
+static constexpr char initial_state_format[] = "initial state: {}";
+static constexpr char rule_format[] = "{} => {}";
 
-    assert(ss);
+PotSet parse_initial_state(std::string_view s)
+{
+    std::string_view state;
+    scan_or_throw<initial_state_format>(s, state);
 
     PotSet p;
     for (int i=0; i<state.size(); ++i)
@@ -114,17 +133,16 @@ PotSet parse_initial_state(const std::string& s)
 }
 
 
-std::pair<RuleVal, char> parse_rule(const std::string& s)
+std::pair<RuleVal, char> parse_rule(std::string_view s)
 {
-    std::stringstream ss(s);
-
-    std::string srule;
-    char result;
+    std::string_view srule;
+    char result = 0;
 
-    ss >> srule >> "=>" >> result;
-    assert(ss);
-    assert(srule.size() == expected_rule_len);
-    assert(result == '.' || result == '#');
+    scan_or_throw<rule_format>(s, srule, result);
+    if (srule.size() != expected_rule_len || (result != '.' && result != '#'))
+    {
+        throw std::runtime_error("Bad rule: " + std::string(s));
+    }
 
     RuleVal r = rule_from_string(srule);
     return {r, result};
@@ -167,6 +185,8 @@ RuleVal extract_pots_next(const PotSet& p, RuleVal v, int i)
 
 PotSet mutate_state(const RuleSet& rules, const PotSet& pots)
 {
+    AOC_TRACE_SCOPE("mutate_state");
+
     PotSet new_pots;
 
     // pad by the rule length so we can produce plants outside of the bounds
@@ -188,9 +208,10 @@ PotSet mutate_state(const RuleSet& rules, const PotSet& pots)
 }
 
 
-size_t sum_of_pots(const PotSet& pots)
+// (pots can drift left of zero, so this can be negative)
+int64_t sum_of_pots(const PotSet& pots)
 {
-    size_t sum = 0;
+    int64_t sum = 0;
     for (const auto& kv : pots)
     {
         assert(kv.second == '#');   // only occupied pots should be present
@@ -201,7 +222,7 @@ size_t sum_of_pots(const PotSet& pots)
 }
 
 
-size_t day12_solve_part1(const RuleSet& rules, const PotSet& initial_state)
+int64_t day12_solve_part1(const RuleSet& rules, const PotSet& initial_state)
 {
     PotSet state = initial_state;
 
@@ -210,61 +231,84 @@ size_t day12_solve_part1(const RuleSet& rules, const PotSet& initial_state)
 }
 
 
-size_t day12_solve_part2(const RuleSet& rules, const PotSet& initial_state)
+// two pot states are the same shape if they're the same apart from a shift along the row
+struct PotShapeHash
 {
-    constexpr size_t target_gen = 50000000000ull;
-    constexpr size_t cycle_check_limit = 10000;
-    PotSet state = initial_state;
-
-    for (size_t i=1; i<=target_gen; ++i)
+    uint64_t operator()(const PotSet& p) const
     {
-        assert(i < cycle_check_limit);      // didn't find a cycle?!
-        auto new_state = mutate_state(rules, state);
+        return hash_mix(std::hash<std::vector<bool>>()(p.to_bits()));
+    }
+};
 
-        // check if this state is just the previous state shifted!
-        if (new_state.to_bits() == state.to_bits())
-        {
-            // state -> new_state is a stable shift...
-            // Instead of iterating through the generations we can just apply the difference in score
-            // That should simply be the number of plants in the pots per shift right
+struct SamePotShape
+{
+    bool operator()(const PotSet& a, const PotSet& b) const
+    {
+        return a.to_bits() == b.to_bits();
+    }
+};
 
-            size_t state_score = sum_of_pots(state);
-            size_t newstate_score = sum_of_pots(new_state);
 
-            size_t delta_score =  newstate_score - state_score;
+int64_t day12_solve_part2(const RuleSet& rules, const PotSet& initial_state)
+{
+    constexpr uint64_t target_gen = 50000000000ull;
 
-            size_t remaining_generations = target_gen - i;
-            size_t total_score = newstate_score + (delta_score * remaining_generations);
+    // the pots settle into a loop of shapes, which moves along the row a fixed amount each time around
+    auto step = [&rules](const PotSet& p) { return mutate_state(rules, p); };
+    Cycle cycle = find_cycle(initial_state, step, PotShapeHash(), SamePotShape());
 
-            return total_score;
-        }
+    const PotSet loop_start = advance(initial_state, step, cycle.mu);
+    const PotSet loop_end = advance(loop_start, step, cycle.lambda);
+    const int64_t shift_per_loop = loop_end.min() - loop_start.min();
 
-        state = new_state;
-    }
+    // so the target is the same shape as an early generation, with every pot moved along by the skipped loops
+    const PotSet state = state_at(initial_state, step, cycle, target_gen);
+    const int64_t pot_count = int64_t(state.size());
+    const int64_t shift = int64_t(cycle.loops_before(target_gen)) * shift_per_loop;
 
-    assert(false);  // unreachable
+    return sum_of_pots(state) + shift * pot_count;
 }
 
 
-
-int main()
+class Day12Solver : public Solver
 {
-    auto file_text = read_file("input.txt");
-    assert(!file_text.empty());
+private:
+    RuleSet rules;
+    PotSet initial_state;
 
-    auto lines = parse_lines(file_text);
-    assert(!lines.empty());
+public:
+    void parse(const std::string& dir) override
+    {
+        MappedFile input(dir + "/input.txt");
+        assert(!input.empty());
 
-    PotSet initial_state = parse_initial_state(lines[0]);
+        auto lines = parse_lines_view(input.text());
+        assert(!lines.empty());
 
-    RuleSet rules;
-    for(auto i = lines.begin() + 2; i != lines.end(); ++i)
+        initial_state = parse_initial_state(lines[0]);
+
+        rules = RuleSet();
+        for(auto i = lines.begin() + 2; i != lines.end(); ++i)
+        {
+            rules.insert(parse_rule(*i));
+        }
+    }
+
+    std::string part1() override
     {
-        rules.insert(parse_rule(*i));
+        return answer(day12_solve_part1(rules, initial_state));
     }
 
-    std::cout << day12_solve_part1(rules, initial_state) << std::endl;
-    std::cout << day12_solve_part2(rules, initial_state) << std::endl;
-    return 0;
+    std::string part2() override
+    {
+        return answer(day12_solve_part2(rules, initial_state));
+    }
+};
+
+
+std::unique_ptr<Solver> make_solver()
+{
+    return std::make_unique<Day12Solver>();
 }
 
+}
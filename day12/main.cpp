@@ -0,0 +1,6 @@
+#include "day12.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day12", day12::make_solver, argc, argv);
+}
@@ -1,8 +1,14 @@
+#include "day13.h"
+
 #include <cassert>
 #include <iostream>
 
 #include "../util/file_parsing.h"
 
+
+namespace day13
+{
+
 // directions... turning cw is an increment mod 4, turning ccw is a decrement mod 4
 enum direction
 {
@@ -292,24 +298,41 @@ std::pair<int, int> day13_solve_part2(const std::vector<struct cart>& initial_ca
 }
 
 
-int main()
+class Day13Solver : public Solver
 {
-    auto file_text = read_file("input.txt");
-    assert(!file_text.empty());
-
-    auto lines = parse_lines(file_text);
-    assert(!lines.empty());
-
+private:
     std::vector<struct cart> carts;
     std::vector<std::vector<char>> tracks;
-    process_tracks(lines, carts, tracks);
 
-    auto result_p1 = day13_solve_part1(carts, tracks);
-    std::cout << result_p1.first << ',' << result_p1.second << std::endl;
+public:
+    void parse(const std::string& dir) override
+    {
+        auto file_text = read_file(dir + "/input.txt");
+        assert(!file_text.empty());
 
-    auto result_p2 = day13_solve_part2(carts, tracks);
-    std::cout << result_p2.first << ',' << result_p2.second << std::endl;
+        auto lines = parse_lines(file_text);
+        assert(!lines.empty());
 
-    return 0;
+        process_tracks(lines, carts, tracks);
+    }
+
+    std::string part1() override
+    {
+        auto result = day13_solve_part1(carts, tracks);
+        return answer(result.first) + "," + answer(result.second);
+    }
+
+    std::string part2() override
+    {
+        auto result = day13_solve_part2(carts, tracks);
+        return answer(result.first) + "," + answer(result.second);
+    }
+};
+
+
+std::unique_ptr<Solver> make_solver()
+{
+    return std::make_unique<Day13Solver>();
 }
 
+}
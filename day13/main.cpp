@@ -0,0 +1,6 @@
+#include "day13.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day13", day13::make_solver, argc, argv);
+}
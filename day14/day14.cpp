@@ -1,3 +1,5 @@
+#include "day14.h"
+
 #include <array>
 #include <cassert>
 #include <iostream>
@@ -5,6 +7,9 @@
 #include <vector>
 
 
+namespace day14
+{
+
 struct generator
 {
     std::array<size_t, 2> elf_positions = {0, 1};
@@ -59,10 +64,35 @@ long day14_solve_part2(const std::vector<int> match)
     }
 }
 
-int main()
+
+class Day14Solver : public Solver
+{
+public:
+    // the puzzle input is in the source, so there's no input directory to read
+    bool reads_input() const override
+    {
+        return false;
+    }
+
+    void parse(const std::string&) override
+    {
+    }
+
+    std::string part1() override
+    {
+        return day14_solve_part1(894501);
+    }
+
+    std::string part2() override
+    {
+        return answer(day14_solve_part2({8, 9, 4, 5, 0, 1}));
+    }
+};
+
+
+std::unique_ptr<Solver> make_solver()
 {
-    std::cout << day14_solve_part1(894501) << std::endl;
-    std::cout << day14_solve_part2({8, 9, 4, 5, 0, 1}) << std::endl;
-    return 0;
+    return std::make_unique<Day14Solver>();
 }
 
+}
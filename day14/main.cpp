@@ -0,0 +1,6 @@
+#include "day14.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day14", day14::make_solver, argc, argv);
+}
@@ -1,16 +1,19 @@
+#include "day15.h"
+
 #include <cassert>
+#include <functional>
 #include <iostream>
 #include <limits>
-#include <queue>
-#include <unordered_set>
 #include <vector>
 
 #include "../util/file_parsing.h"
 #include "../util/grid.h"
-
+#include "../util/search.h"
+#include "../util/trace.h"
 
 
 // compare points in reading order
+// (Point comes from grid.h, so these have to be outside the day's namespace for lookup to find them)
 bool operator<(const Point& a, const Point& o)
 {
     if (a.y != o.y) return a.y < o.y;
@@ -34,18 +37,19 @@ bool operator!=(const Point& a, const Point& o)
 }
 
 
-bool any_neighbour_matches(char c, const NoddySparseGrid<char>& g, Point p)
+namespace day15
+{
+
+bool any_neighbour_matches(char c, const DenseGrid<char>& g, Point p)
 {
     // return true if any of the 4-neighbours of p match c
+    // (the grid has a halo of wall, so the neighbours of an edge point are always readable)
     Point up{p.x, p.y - 1};
     Point down{p.x, p.y + 1};
     Point left{p.x - 1, p.y};
     Point right{p.x + 1, p.y};
 
-    return (up.is_positive() && g[up] == c) ||
-           (down.is_positive() && g[down] == c) ||
-           (left.is_positive() && g[left] == c) ||
-           (right.is_positive() && g[right] == c);
+    return g[up] == c || g[down] == c || g[left] == c || g[right] == c;
 }
 
 bool are_neighbours(Point a, Point b)
@@ -71,70 +75,72 @@ char opposite_team(char c)
 }
 
 
-Point find_matching_point(const Point& origin, const NoddySparseGrid<char>& grid, const std::function<bool(const Point&)>& stopping_condition)
+// the open cavern squares, as a graph for GraphSearch (nodes are the grid's cell indices)
+struct CaveGraph
+{
+    typedef int cost_type;
+
+    const DenseGrid<char>& grid;
+
+    size_t node_count() const
+    {
+        return grid.cell_count();
+    }
+
+    template<typename Emit>
+    void neighbours(size_t node, Emit&& emit) const
+    {
+        // the grid has a halo of wall, so the neighbours of an edge point are always readable
+        const size_t stride = grid.stride();
+
+        if (grid.at_index(node - stride) == '.') emit(node - stride, 1);
+        if (grid.at_index(node + stride) == '.') emit(node + stride, 1);
+        if (grid.at_index(node - 1) == '.') emit(node - 1, 1);
+        if (grid.at_index(node + 1) == '.') emit(node + 1, 1);
+    }
+
+    cost_type heuristic(size_t) const { return 0; }
+    cost_type max_step_cost() const { return 1; }
+};
+
+
+Point find_matching_point(const Point& origin, const DenseGrid<char>& grid, const std::function<bool(const Point&)>& stopping_condition)
 {
+    AOC_TRACE_SCOPE("find_matching_point");
+
     // Find the nearest point to the origin that satisfies the stopping condition
     // If there are multiple points that satisfy the condition at the same distance, then
     // select the candidate based on reading order.
 
-    // To do this, use a simple dijkstra until we hit an appropriate stopping point (e.g. we've hit
-    // a neighbour of a unit of the opposing type).
+    // To do this, use a simple BFS until we've seen every candidate at the nearest stopping distance
+    // (e.g. we've hit all the neighbours of units of the opposing type that are that close).
+    // This is run twice per unit per round, so the search keeps its buffers between calls
+    // (one search per thread, as several caves can be being solved at once).
+    static thread_local GraphSearch<CaveGraph> search;
+
     constexpr int int_max = std::numeric_limits<int>::max();
     const Point not_visited_point { int_max, int_max };
 
-    const std::pair<int, Point> not_visited { int_max, Point(int_max, int_max)};
-
-    NoddySparseGrid<std::pair<int, Point>> closed(not_visited);    // distance, from-point
-
-    std::deque<std::tuple<int, Point, Point>> open;             // distance, point, from-point
-    open.emplace_back(0, origin, origin);
-
     Point end_point = not_visited_point;       // best end-point, based on reading order
 
-    int stop_at_distance = std::numeric_limits<int>::max();
-    while(!open.empty())
+    int stop_at_distance = int_max;
+    search.run(CaveGraph{grid}, grid.index_of(origin), [&](size_t node, int dist) -> bool
     {
-        // Pop this candidate and it's distance
-        auto candidate_tuple = open.front();
-        open.pop_front();
-
-        const int dist = std::get<0>(candidate_tuple);
-        const Point& p = std::get<1>(candidate_tuple);
-        const Point& fp = std::get<2>(candidate_tuple);
-
         // If this distance is bigger than our stop-limit... stop!
-        // because of how dijkstra works without edge-costs, distance should be monotonic
-        if (dist > stop_at_distance) break;
+        // points are settled in order of distance, so nothing later can be nearer
+        if (dist > stop_at_distance) return false;
 
-        // If this is a possible stopping point, enqueue it in the stopping points and set the distance limit
+        // If this is a possible stopping point, set the distance limit
+        // but don't stop yet - there may be other points at this distance that are first in reading order
+        Point p = grid.point_at(node);
         if (stopping_condition(p))
         {
             stop_at_distance = dist;
             end_point = std::min(end_point, p);
-
-            // but don't stop yet - this could be the best path to a point so far
         }
 
-        // If this candidate path is better than the existing to this point, then use this path
-        auto& closed_entry = closed[p];
-        if (dist < closed_entry.first)
-        {
-            // This candidate is better - use it as the path to this point
-            closed_entry.first = dist;
-            closed_entry.second = fp;
-
-            // (Re-)enqueue the neighbours if they're walkable at this distance
-            Point up{p.x, p.y - 1};
-            Point down{p.x, p.y + 1};
-            Point left{p.x - 1, p.y};
-            Point right{p.x + 1, p.y};
-
-            if (up.is_positive() && grid[up] == '.' && not_visited == closed[up]) open.emplace_back(dist + 1, up, p);
-            if (down.is_positive() && grid[down] == '.' && not_visited == closed[down]) open.emplace_back(dist + 1, down, p);
-            if (left.is_positive() && grid[left] == '.' && not_visited == closed[left]) open.emplace_back(dist + 1, left, p);
-            if (right.is_positive() && grid[right] == '.' && not_visited == closed[right]) open.emplace_back(dist + 1, right, p);
-        }
-    }
+        return true;
+    });
 
     if (end_point != not_visited_point) return end_point;
 
@@ -142,7 +148,7 @@ Point find_matching_point(const Point& origin, const NoddySparseGrid<char>& grid
     return Point(-1, -1);
 }
 
-Point next_move(const Point& unit, const NoddySparseGrid<char>& grid)
+Point next_move(const Point& unit, const DenseGrid<char>& grid)
 {
     // To find the next move to make, find the nearest reachable neighbour of the opposing team (in reading order)
     // then find the nearest neighbour of ourselves (also in reading order).
@@ -169,10 +175,16 @@ Point next_move(const Point& unit, const NoddySparseGrid<char>& grid)
 }
 
 
-void populate_grid_and_units(NoddySparseGrid<char>& g, std::vector<std::pair<Point, int>>& units, const std::vector<std::string>& lines)
+void populate_grid_and_units(DenseGrid<char>& g, std::vector<std::pair<Point, int>>& units, const std::vector<std::string>& lines)
 {
     constexpr int initial_hp = 200;
 
+    // anything off the edge of the map (or past the end of a short line) is wall
+    size_t columns = 0;
+    for (auto& l : lines) columns = std::max(columns, l.size());
+    g = DenseGrid<char>(columns, lines.size(), '#', 1);
+    units.clear();
+
     for (size_t y = 0; y < lines.size(); y++)
     {
         auto& l = lines[y];
@@ -186,7 +198,7 @@ void populate_grid_and_units(NoddySparseGrid<char>& g, std::vector<std::pair<Poi
 }
 
 
-void move_unit(const Point& from, const Point& to, NoddySparseGrid<char>& grid)
+void move_unit(const Point& from, const Point& to, DenseGrid<char>& grid)
 {
     assert(from != to);
     assert(are_neighbours(from, to));
@@ -198,7 +210,7 @@ void move_unit(const Point& from, const Point& to, NoddySparseGrid<char>& grid)
 }
 
 
-std::vector<std::pair<Point, int>>::iterator find_attacked_unit(const Point& atacking_unit_pos, const NoddySparseGrid<char>& grid, std::vector<std::pair<Point, int>>& units)
+std::vector<std::pair<Point, int>>::iterator find_attacked_unit(const Point& atacking_unit_pos, const DenseGrid<char>& grid, std::vector<std::pair<Point, int>>& units)
 {
     // Find the position of the neighbouring unit with the lowest health
     // This is the inverse of what's in units! We want to invert the minimum ordering of the tuple, so that we pick
@@ -232,7 +244,7 @@ std::vector<std::pair<Point, int>>::iterator find_attacked_unit(const Point& ata
 }
 
 
-void run_one_round(NoddySparseGrid<char>& grid, std::vector<std::pair<Point, int>>& units, int& goblin_count, int& elf_count, int elf_attack_power)
+void run_one_round(DenseGrid<char>& grid, std::vector<std::pair<Point, int>>& units, int& goblin_count, int& elf_count, int elf_attack_power)
 {
     constexpr int goblin_attack_power = 3;
     assert(units.size() == goblin_count + elf_count);   // should only have elves and goblins!
@@ -284,8 +296,10 @@ void run_one_round(NoddySparseGrid<char>& grid, std::vector<std::pair<Point, int
 }
 
 
-int run_until_winner_or_elf_death(NoddySparseGrid<char>& grid, std::vector<std::pair<Point, int>>& units, bool ignore_elf_deaths = true, int elf_attack_power = 3)
+int run_until_winner_or_elf_death(DenseGrid<char>& grid, std::vector<std::pair<Point, int>>& units, bool ignore_elf_deaths = true, int elf_attack_power = 3)
 {
+    AOC_TRACE_SCOPE("battle");
+
     // count the number of goblin/elf units
     int goblin_count = 0;
     int elf_count = 0;
@@ -312,10 +326,18 @@ int run_until_winner_or_elf_death(NoddySparseGrid<char>& grid, std::vector<std::
     return round - 1;   // the last 'round' didn't complete!
 }
 
-int day15_solve_part1(const NoddySparseGrid<char>& initial_grid, const std::vector<std::pair<Point, int>>& initial_units)
+// a fresh copy of the starting grid for a battle (a function of its own so the copies show up in a trace)
+DenseGrid<char> copy_grid(const DenseGrid<char>& grid)
+{
+    AOC_TRACE_SCOPE("copy_grid");
+    return grid;
+}
+
+
+int day15_solve_part1(const DenseGrid<char>& initial_grid, const std::vector<std::pair<Point, int>>& initial_units)
 {
 
-    auto grid = initial_grid;
+    auto grid = copy_grid(initial_grid);
     auto units = initial_units;
 
     // run the simulation
@@ -329,8 +351,7 @@ int day15_solve_part1(const NoddySparseGrid<char>& initial_grid, const std::vect
 }
 
 
-
-int day15_solve_part2(const NoddySparseGrid<char>& initial_grid, const std::vector<std::pair<Point, int>>& initial_units)
+int day15_solve_part2(const DenseGrid<char>& initial_grid, const std::vector<std::pair<Point, int>>& initial_units)
 {
     auto units = initial_units;
 
@@ -340,7 +361,7 @@ int day15_solve_part2(const NoddySparseGrid<char>& initial_grid, const std::vect
     while (rounds < 0)
     {
         units = initial_units;
-        auto grid = initial_grid;
+        auto grid = copy_grid(initial_grid);
         rounds = run_until_winner_or_elf_death(grid, units, false, ++attack_power);
     }
 
@@ -352,21 +373,39 @@ int day15_solve_part2(const NoddySparseGrid<char>& initial_grid, const std::vect
 }
 
 
-int main()
+class Day15Solver : public Solver
 {
+private:
+    DenseGrid<char> grid;
+    std::vector<std::pair<Point, int>> units;
 
-    auto file_text = read_file("input.txt");
-    assert(!file_text.empty());
+public:
+    void parse(const std::string& dir) override
+    {
+        auto file_text = read_file(dir + "/input.txt");
+        assert(!file_text.empty());
 
-    auto lines = parse_lines(file_text);
-    assert(!lines.empty());
+        auto lines = parse_lines(file_text);
+        assert(!lines.empty());
 
-    NoddySparseGrid<char> grid;
-    std::vector<std::pair<Point, int>> units;
-    populate_grid_and_units(grid, units, lines);
+        populate_grid_and_units(grid, units, lines);
+    }
+
+    std::string part1() override
+    {
+        return answer(day15_solve_part1(grid, units));
+    }
 
-    std::cout << day15_solve_part1(grid, units) << std::endl;
-    std::cout << day15_solve_part2(grid, units) << std::endl;
-    return 0;
+    std::string part2() override
+    {
+        return answer(day15_solve_part2(grid, units));
+    }
+};
+
+
+std::unique_ptr<Solver> make_solver()
+{
+    return std::make_unique<Day15Solver>();
 }
 
+}
@@ -0,0 +1,6 @@
+#include "day15.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day15", day15::make_solver, argc, argv);
+}
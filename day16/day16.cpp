@@ -1,29 +1,33 @@
+#include "day16.h"
+
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <iostream>
 #include <functional>
-#include <sstream>
+#include <limits>
+#include <stdexcept>
 #include <unordered_set>
 #include <bitset>
 #include <numeric>
 
 #include "../util/file_parsing.h"
+#include "../util/format_scan.h"
+
 
+namespace day16
+{
 
 constexpr size_t RegisterCount = 4; // must be set before the include
 #include "../util/aoc_cpu.h"
 
 using Opcode = std::array<RegisterType, 4>;
-const std::array<InstructionFunc, 16> instructions
-        {
-                addr, addi,
-                mulr, muli,
-                banr, bani,
-                borr, bori,
-                setr, seti,
-                gtir, gtri, gtrr,
-                eqir, eqri, eqrr
-        };
+
+// an opcode's operands, as if it were the op with this index
+DecodedInstruction decode_as(size_t op_index, const Opcode& o)
+{
+    return {static_cast<Op>(op_index), o[1], o[2], o[3]};
+}
 
 
 struct Sample
@@ -33,22 +37,21 @@ struct Sample
     Registers after;
 };
 
-Opcode parse_opcode(const std::string &l)
+static constexpr char opcode_format[] = "{} {} {} {}";
+static constexpr char before_format[] = "Before: [{}, {}, {}, {}]";
+static constexpr char after_format[] = "After: [{}, {}, {}, {}]";
+
+Opcode parse_opcode(std::string_view l)
 {
     Opcode i;
 
-    std::stringstream ss(l);
-    ss >> i[0]
-       >> i[1]
-       >> i[2]
-       >> i[3];
-    assert(ss);
+    scan_or_throw<opcode_format>(l, i[0], i[1], i[2], i[3]);
 
     return i;
 
 }
 
-std::vector<Sample> parse_samples(const std::vector<std::string>& lines)
+std::vector<Sample> parse_samples(const std::vector<std::string_view>& lines)
 {
     std::vector<Sample> samples;
 
@@ -57,26 +60,14 @@ std::vector<Sample> parse_samples(const std::vector<std::string>& lines)
         // We expect a 'before' line, an instruction line, and an 'after' line, then a blank line!
         Sample sample = {0};
 
-        std::stringstream before_ss(*l++);
-        before_ss >> "Before:" >> '['
-                  >> sample.before[0] >> ','
-                  >> sample.before[1] >> ','
-                  >> sample.before[2] >> ','
-                  >> sample.before[3] >> ']';
-        assert(before_ss);
+        scan_or_throw<before_format>(*l++, sample.before[0], sample.before[1], sample.before[2], sample.before[3]);
         assert(l != lines.end());
 
 
         sample.instruction = parse_opcode(*l++);
         assert(l != lines.end());
 
-        std::stringstream after_ss(*l++);
-        after_ss >> "After:" >> '['
-                  >> sample.after[0] >> ','
-                  >> sample.after[1] >> ','
-                  >> sample.after[2] >> ','
-                  >> sample.after[3] >> ']';
-        assert(after_ss);
+        scan_or_throw<after_format>(*l++, sample.after[0], sample.after[1], sample.after[2], sample.after[3]);
         assert(l != lines.end());
 
         ++l;    // for the expected blank line
@@ -96,10 +87,10 @@ int day16_solve_part1(const std::vector<Sample>& samples)
     for (auto& s : samples)
     {
         int matching_instructions = 0;
-        for (auto& i : instructions)
+        for (size_t op_index = 0; op_index < OpCount; ++op_index)
         {
             Registers registers = s.before;
-            i(registers, s.instruction[1], s.instruction[2], s.instruction[3]);
+            execute(decode_as(op_index, s.instruction), registers);
 
             if (registers == s.after) ++matching_instructions;
         }
@@ -126,7 +117,7 @@ int day16_solve_part2(const std::vector<Sample>& samples, const std::vector<Opco
 
             // fill the vector with indices in order
             // (not that the order matters! :)
-            v.resize(instructions.size());
+            v.resize(OpCount);
             std::iota(v.begin(), v.end(), 0);
         }
     }
@@ -141,7 +132,7 @@ int day16_solve_part2(const std::vector<Sample>& samples, const std::vector<Opco
         auto& v = iter->second;
         auto ri = std::remove_if(v.begin(), v.end(), [&](size_t index)->bool{
             Registers registers = s.before;
-            instructions[index](registers, s.instruction[1], s.instruction[2], s.instruction[3]);
+            execute(decode_as(index, s.instruction), registers);
             return (registers != s.after);
         });
 
@@ -149,7 +140,7 @@ int day16_solve_part2(const std::vector<Sample>& samples, const std::vector<Opco
     }
 
     // now make the instructions unique by doing cycles excluding the known instructions
-    std::unordered_map<RegisterType, InstructionFunc> opcode_instructions;
+    std::unordered_map<RegisterType, Op> opcode_instructions;
     while(opcode_instructions.size() < opcode_possible_instructions.size())
     {
         for(auto& kv : opcode_possible_instructions)
@@ -163,7 +154,7 @@ int day16_solve_part2(const std::vector<Sample>& samples, const std::vector<Opco
             {
                 // set this opcode
                 size_t instruction_index = v[0];
-                opcode_instructions[kv.first] = instructions[instruction_index];
+                opcode_instructions[kv.first] = static_cast<Op>(instruction_index);
 
                 // exclude this instruction index from all other possible opcodes
                 for(auto& exkv : opcode_possible_instructions)
@@ -183,34 +174,54 @@ int day16_solve_part2(const std::vector<Sample>& samples, const std::vector<Opco
         auto iter = opcode_instructions.find(pi[0]);
         assert(iter != opcode_instructions.end());     // unknown opcode?! eh?
 
-        const auto& i = iter->second;
-        i(r, pi[1], pi[2], pi[3]);
+        execute({iter->second, pi[1], pi[2], pi[3]}, r);
     }
 
     return r[0];
 }
 
 
-int main()
+class Day16Solver : public Solver
 {
-    auto samples_text = read_file("input.txt");
-    assert(!samples_text.empty());
+private:
+    std::vector<Sample> samples;
+    std::vector<Opcode> program;
+
+public:
+    void parse(const std::string& dir) override
+    {
+        MappedFile samples_input(dir + "/input.txt");
+        assert(!samples_input.empty());
 
-    auto samples_lines = parse_lines(samples_text);
-    assert(!samples_lines.empty());
+        auto samples_lines = parse_lines_view(samples_input.text());
+        assert(!samples_lines.empty());
 
-    auto samples = parse_samples(samples_lines);
-    std::cout << day16_solve_part1(samples) << std::endl;
+        samples = parse_samples(samples_lines);
 
-    auto program_text = read_file("input_instrs.txt");
-    assert(!program_text.empty());
+        MappedFile program_input(dir + "/input_instrs.txt");
+        assert(!program_input.empty());
 
-    auto program_lines = parse_lines(program_text);
-    assert(!program_lines.empty());
+        auto program_lines = parse_lines_view(program_input.text());
+        assert(!program_lines.empty());
 
-    auto program = convert_strings<Opcode>(program_lines, parse_opcode);
-    std::cout << day16_solve_part2(samples, program) << std::endl;
+        program = convert_strings<Opcode>(program_lines, parse_opcode);
+    }
+
+    std::string part1() override
+    {
+        return answer(day16_solve_part1(samples));
+    }
 
-    return 0;
+    std::string part2() override
+    {
+        return answer(day16_solve_part2(samples, program));
+    }
+};
+
+
+std::unique_ptr<Solver> make_solver()
+{
+    return std::make_unique<Day16Solver>();
 }
 
+}
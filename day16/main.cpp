@@ -0,0 +1,6 @@
+#include "day16.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day16", day16::make_solver, argc, argv);
+}
@@ -1,50 +1,93 @@
+#include "day17.h"
+
 #include <cassert>
 #include <iostream>
-#include <sstream>
+#include <limits>
 #include <fstream>
+#include <stdexcept>
+#include <string>
 
 #include "../util/file_parsing.h"
+#include "../util/format_scan.h"
 #include "../util/grid.h"
 
 
+namespace day17
+{
+
+// each tile is a 2-bit lane
+using Grid = PackedGrid<2>;
+
+constexpr unsigned tileSand = 0;
+constexpr unsigned tileClay = 1;
+constexpr unsigned tileFlowing = 2;
+constexpr unsigned tileWater = 3;
 
-using Grid = NoddySparseGrid<char>;
+static constexpr char ordinates_format[] = "{}={}, {}={}..{}";
 
-std::pair<int, int> process_ordinates(Grid& g, const std::vector<std::string>& ordinates)
+struct clay_vein
 {
-    int miny = std::numeric_limits<int>::max();
-    int maxy = std::numeric_limits<int>::min();
+    int minx, maxx;
+    int miny, maxy;
+};
+
+std::vector<clay_vein> parse_veins(const std::vector<std::string_view>& ordinates)
+{
+    std::vector<clay_vein> veins;
+    veins.reserve(ordinates.size());
 
     for (auto& l : ordinates)
     {
-        std::stringstream ss(l);
-
         char first_ord, second_ord;
         int first_val, second_val, third_val;
 
-        ss >> first_ord >> '=' >> first_val >> ','
-           >> second_ord >> '=' >> second_val >> ".." >> third_val;
-
-        assert(ss);
-        assert(first_ord == 'x' || first_ord == 'y');
-        if (first_ord == 'x')
+        scan_or_throw<ordinates_format>(l, first_ord, first_val, second_ord, second_val, third_val);
+        if (first_ord == 'x' && second_ord == 'y')
+        {
+            veins.push_back({first_val, first_val, second_val, third_val});
+        }
+        else if (first_ord == 'y' && second_ord == 'x')
         {
-            assert(second_ord == 'y');
-            int x = first_val;
-            for (int y = second_val; y<=third_val; ++y)
-            {
-                g[y][x] = '#';
-                miny = std::min(miny, y);
-                maxy = std::max(maxy, y);
-            }
+            veins.push_back({second_val, third_val, first_val, first_val});
         }
         else
         {
-            assert(second_ord == 'x');
-            int y = first_val;
-            miny = std::min(miny, y);
-            maxy = std::max(maxy, y);
-            for (int x = second_val; x<=third_val; ++x) g[y][x] = '#';
+            throw std::runtime_error("Bad vein: " + std::string(l));
+        }
+    }
+
+    return veins;
+}
+
+// build the grid of clay, just big enough to hold the veins and any water that flows around them
+// returns the y-bounds of the clay, and sets the x-offset of the grid (so grid column c is at x = c + xoffset)
+std::pair<int, int> process_ordinates(Grid& g, int& xoffset, const std::vector<std::string_view>& ordinates)
+{
+    auto veins = parse_veins(ordinates);
+
+    int minx = std::numeric_limits<int>::max();
+    int maxx = std::numeric_limits<int>::min();
+    int miny = std::numeric_limits<int>::max();
+    int maxy = std::numeric_limits<int>::min();
+
+    for (auto& v : veins)
+    {
+        minx = std::min(minx, v.minx);
+        maxx = std::max(maxx, v.maxx);
+        miny = std::min(miny, v.miny);
+        maxy = std::max(maxy, v.maxy);
+    }
+    assert(miny >= 1);  // leave room for the spring above the clay
+
+    // water can spill past the outermost clay by one column either side
+    xoffset = minx - 1;
+    g = Grid(maxx - minx + 3, maxy + 1, tileSand);
+
+    for (auto& v : veins)
+    {
+        for (int y = v.miny; y <= v.maxy; ++y)
+        {
+            for (int x = v.minx; x <= v.maxx; ++x) g.set(x - xoffset, y, tileClay);
         }
     }
 
@@ -56,7 +99,7 @@ void print_grid(std::ostream& os, const Grid& g)
 {
     for(size_t r = 0; r < g.rows(); ++r)
     {
-        for(size_t c = 0; c < g.columns(); ++c) os << g[r][c];
+        for(size_t c = 0; c < g.columns(); ++c) os << ".#|~"[g.get(c, r)];
         os << std::endl;
     }
 }
@@ -65,20 +108,18 @@ void print_grid(std::ostream& os, const Grid& g)
 struct flow_result
 {
     int wet_tiles = 0;
-    int retained_tiles = 0;
     bool blocked = false;
 
     flow_result& operator+=(const flow_result& o)
     {
         wet_tiles += o.wet_tiles;
-        retained_tiles += o.retained_tiles;
 
         // don't propagate blocking on addition
+        return *this;
     }
 };
 
 
-
 flow_result flow(const std::pair<int, int>& ybounds, Grid& grid, Point p, bool ignore_left = false, bool ignore_right = false)
 {
     flow_result result{};
@@ -88,21 +129,22 @@ flow_result flow(const std::pair<int, int>& ybounds, Grid& grid, Point p, bool i
 
     // if we're a blocking tile (water or clay) then this is a blocked, zero-wet-tiles end-state
     // (if we're water, then we're already counted)
-    if (grid[p] == '#' || grid[p] == '~')
+    const unsigned tile = grid.get(p);
+    if (tile == tileClay || tile == tileWater)
     {
         result.blocked = true;
         return result;
     }
 
     // if we're already a flow tile... then ... what?
-    if (grid[p] == '|')
+    if (tile == tileFlowing)
     {
         int x = 0;
         return result;  // not-blocked, no extra count?
     }
 
     // This MUST be a wet tile. If it's within bounds, count it
-    grid[p] = '|';
+    grid.set(p, tileFlowing);
     if (p.y >= ybounds.first && p.y <= ybounds.second) ++result.wet_tiles;
 
     // check below
@@ -142,40 +184,79 @@ flow_result flow(const std::pair<int, int>& ybounds, Grid& grid, Point p, bool i
     if ((!ignore_left && !ignore_right) && result.blocked)
     {
         // fill this tile - we're not flowing
-        grid[p] = '~';
-        ++result.retained_tiles;
+        grid.set(p, tileWater);
 
-        // also left and right of here that are flow characters are filling
-        for (int x = p.x + 1; grid[p.y][x] == '|'; ++x) { grid[p.y][x] = '~'; ++result.retained_tiles; }
-        for (int x = p.x - 1; grid[p.y][x] == '|'; --x) { grid[p.y][x] = '~'; ++result.retained_tiles; }
+        // also left and right of here that are flow tiles are filling
+        for (int x = p.x + 1; grid.get(x, p.y) == tileFlowing; ++x) grid.set(x, p.y, tileWater);
+        for (int x = p.x - 1; grid.get(x, p.y) == tileFlowing; --x) grid.set(x, p.y, tileWater);
     }
 
     return result;
 }
 
-flow_result day17_solve_part1_and_2(const std::pair<int, int>& ybounds, const Grid& initial_grid)
+// let the water flow from the spring, leaving it in 'grid', and count the tiles it reaches
+int day17_solve_part1(const std::pair<int, int>& ybounds, int xoffset, const Grid& initial_grid, Grid& grid)
 {
-    const Point spring{500, ybounds.first - 1};
-    Grid grid = initial_grid;
+    const Point spring{500 - xoffset, ybounds.first - 1};
+    grid = initial_grid;
+
+    return flow(ybounds, grid, spring).wet_tiles;
+}
 
-    return flow(ybounds, grid, spring);
+// count the water left standing once it's all flowed (in the grid part 1 left behind)
+int day17_solve_part2(const std::pair<int, int>& ybounds, const Grid& grid)
+{
+    // a word at a time: water is the only tile with both its bits set
+    static_assert(tileWater == Grid::lane_mask, "water has to be the only tile with both bits set");
+
+    int retained_tiles = 0;
+    for (int y = ybounds.first; y <= ybounds.second; ++y)
+    {
+        const Grid::word_type* row = grid.row(size_t(y));
+        for (size_t i = 0; i < grid.words_per_row(); ++i)
+        {
+            retained_tiles += __builtin_popcountll(row[i] & (row[i] >> 1) & Grid::low_bits);
+        }
+    }
+    return retained_tiles;
 }
 
-int main()
+
+class Day17Solver : public Solver
 {
-    auto file_text = read_file("input.txt");
-    assert(!file_text.empty());
+private:
+    Grid grid;
+    int xoffset = 0;
+    std::pair<int, int> ybounds;
+    Grid flowed;
+
+public:
+    void parse(const std::string& dir) override
+    {
+        MappedFile input(dir + "/input.txt");
+        assert(!input.empty());
 
-    auto lines = parse_lines(file_text);
-    assert(!lines.empty());
+        auto lines = parse_lines_view(input.text());
+        assert(!lines.empty());
 
-    Grid grid('.');
-    auto ybounds = process_ordinates(grid, lines);
+        ybounds = process_ordinates(grid, xoffset, lines);
+    }
 
-    auto result = day17_solve_part1_and_2(ybounds, grid);
+    std::string part1() override
+    {
+        return answer(day17_solve_part1(ybounds, xoffset, grid, flowed));
+    }
 
-    std::cout << result.wet_tiles << std::endl;
-    std::cout << result.retained_tiles << std::endl;
-    return 0;
+    std::string part2() override
+    {
+        return answer(day17_solve_part2(ybounds, flowed));
+    }
+};
+
+
+std::unique_ptr<Solver> make_solver()
+{
+    return std::make_unique<Day17Solver>();
 }
 
+}
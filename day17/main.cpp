@@ -0,0 +1,6 @@
+#include "day17.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day17", day17::make_solver, argc, argv);
+}
@@ -1,81 +1,141 @@
+#include "day18.h"
+
 #include <cassert>
 #include <iostream>
 
+#include "../util/cycle.h"
 #include "../util/file_parsing.h"
 #include "../util/grid.h"
+#include "../util/hash.h"
 
 
-void populate_grid(NoddySparseGrid<char>& g, const std::vector<std::string>& lines)
+namespace day18
 {
+
+// each acre is a 2-bit lane: open ground is 00, trees are 01 and a lumberyard is 10
+using Grid = PackedGrid<2>;
+
+constexpr unsigned acreOpen = 0;
+constexpr unsigned acreTrees = 1;
+constexpr unsigned acreLumberyard = 2;
+
+constexpr Grid::word_type low_bits = Grid::low_bits;
+
+
+unsigned char_to_acre(char c)
+{
+    if (c == '.') return acreOpen;
+    if (c == '|') return acreTrees;
+    if (c == '#') return acreLumberyard;
+
+    assert(false);
+    throw std::runtime_error("Unknown acre character");
+}
+
+void populate_grid(Grid& g, const std::vector<std::string>& lines)
+{
+    g = Grid(lines[0].size(), lines.size(), acreOpen);
+
     for (size_t y = 0; y<lines.size(); ++y)
     {
         const auto& l = lines[y];
         for (size_t x = 0; x<l.size(); ++x)
         {
-            g[y][x] = l[x];
+            g.set(x, y, char_to_acre(l[x]));
         }
     }
 }
 
-int adjacent_count(char c, const NoddySparseGrid<char>& g, size_t ox, size_t oy)
+void print_grid(std::ostream& os, const Grid& g)
 {
-    size_t minx = ox >= 1 ? ox - 1 : ox;
-    size_t miny = oy >= 1 ? oy - 1 : oy;
-
-    int count = 0;
-    for (size_t y = miny ; y <= oy + 1; ++y)
+    for(size_t r = 0; r < g.rows(); ++r)
     {
-        for (size_t x = minx; x <= ox + 1; ++x)
-        {
-            if (x==ox && y==oy) continue;   // skip center tile
-            if (g[y][x] == c) ++count;
-        }
+        for(size_t c = 0; c < g.columns(); ++c) os << ".|#"[g.get(c, r)];
+        os << std::endl;
     }
-
-    return count;
 }
 
-char update_state(const NoddySparseGrid<char>& g, size_t x, size_t y)
+
+// The neighbour counts are done on whole words, bit-sliced: each lane's low bit says whether that acre
+// is of the kind being counted, and the 8 neighbours' bits are added up in 'at least 1/2/3' saturating counters.
+struct NeighbourCounts
 {
-    char c = g[y][x];
-    if (c == '.')
-    {
-        return adjacent_count('|', g, x, y) >= 3 ? '|' : '.';
-    }
-    else if (c == '|')
-    {
-        return adjacent_count('#', g, x, y) >= 3 ? '#' : '|';
-    }
-    else if (c == '#')
+    Grid::word_type at_least_1 = 0;
+    Grid::word_type at_least_2 = 0;
+    Grid::word_type at_least_3 = 0;
+
+    void add(Grid::word_type n)
     {
-        return (adjacent_count('#', g, x, y)>=1 && adjacent_count('|', g, x, y)>=1)? '#' : '.';
+        at_least_3 |= at_least_2 & n;
+        at_least_2 |= at_least_1 & n;
+        at_least_1 |= n;
     }
-    else assert(false); // unknown state?!
-}
+};
 
-void print_grid(std::ostream& os, const NoddySparseGrid<char>& g)
+// add the three neighbours in a row (left, middle, right), or just left and right for the centre row
+// prev and next are the neighbouring words in the row, so lanes can shift in across the word boundaries
+void add_row_neighbours(NeighbourCounts& counts, Grid::word_type prev, Grid::word_type w, Grid::word_type next, bool include_middle)
 {
-    for(size_t r = 0; r < g.rows(); ++r)
-    {
-        for(size_t c = 0; c < g.columns(); ++c) os << g[r][c];
-        os << std::endl;
-    }
+    counts.add((w << 2) | (prev >> 62));    // the acre to the left, moved into our lane
+    counts.add((w >> 2) | (next << 62));    // the acre to the right
+    if (include_middle) counts.add(w);
 }
 
-size_t run_one_step(const NoddySparseGrid<char>& sg, NoddySparseGrid<char>& dg)
+size_t run_one_step(const Grid& sg, Grid& dg)
 {
     size_t wooded = 0;
     size_t lumber_yards = 0;
 
+    const size_t n_words = sg.words_per_row();
+    const std::vector<Grid::word_type> empty_row(n_words, 0);   // the open ground off the top and bottom edges
+
     for (size_t r = 0; r < sg.rows(); ++r)
     {
-        for (size_t c = 0; c < sg.columns(); ++c)
+        const Grid::word_type* rows[3] = {
+            r > 0 ? sg.row(r - 1) : empty_row.data(),
+            sg.row(r),
+            r + 1 < sg.rows() ? sg.row(r + 1) : empty_row.data()
+        };
+        Grid::word_type* out = dg.row(r);
+
+        for (size_t i = 0; i < n_words; ++i)
         {
-            char t = update_state(sg, c, r);
-            dg[r][c] = t;
+            NeighbourCounts trees;
+            NeighbourCounts lumber;
+
+            for (int k = 0; k < 3; ++k)
+            {
+                const Grid::word_type* row = rows[k];
+                Grid::word_type prev = i > 0 ? row[i - 1] : 0;
+                Grid::word_type w = row[i];
+                Grid::word_type next = i + 1 < n_words ? row[i + 1] : 0;
+
+                // split the lanes into tree and lumberyard indicators
+                add_row_neighbours(trees, prev & low_bits, w & low_bits, next & low_bits, k != 1);
+                add_row_neighbours(lumber, (prev >> 1) & low_bits, (w >> 1) & low_bits, (next >> 1) & low_bits, k != 1);
+            }
+
+            const Grid::word_type w = rows[1][i];
+            const Grid::word_type is_trees = w & low_bits;
+            const Grid::word_type is_lumber = (w >> 1) & low_bits;
+            const Grid::word_type is_open = ~(is_trees | is_lumber) & low_bits;
+
+            // open becomes trees with 3+ trees around it, trees become a lumberyard with 3+ lumberyards around it,
+            // and a lumberyard stays only if there's at least one of each around it
+            Grid::word_type new_trees = (is_open & trees.at_least_3) | (is_trees & ~lumber.at_least_3);
+            Grid::word_type new_lumber = (is_trees & lumber.at_least_3) | (is_lumber & lumber.at_least_1 & trees.at_least_1);
+
+            // keep the lanes off the end of the row clear
+            if (i + 1 == n_words)
+            {
+                new_trees &= sg.last_word_mask();
+                new_lumber &= sg.last_word_mask();
+            }
 
-            if (t=='|') ++wooded;
-            if (t=='#') ++lumber_yards;
+            out[i] = new_trees | (new_lumber << 1);
+
+            wooded += __builtin_popcountll(new_trees);
+            lumber_yards += __builtin_popcountll(new_lumber);
         }
     }
 
@@ -83,22 +143,21 @@ size_t run_one_step(const NoddySparseGrid<char>& sg, NoddySparseGrid<char>& dg)
 }
 
 
-
-size_t day18_solve_part1(size_t iterations, const NoddySparseGrid<char>& initial_grid)
+size_t day18_solve_part1(size_t iterations, const Grid& initial_grid)
 {
-    NoddySparseGrid<char> grid1 = initial_grid;
-    NoddySparseGrid<char> grid2;
+    Grid grid1 = initial_grid;
+    Grid grid2 = initial_grid;
 
-    NoddySparseGrid<char>* source_grid_ptr = &grid1;
-    NoddySparseGrid<char>* dest_grid_ptr = &grid2;
+    Grid* source_grid_ptr = &grid1;
+    Grid* dest_grid_ptr = &grid2;
 
     size_t resource_value = 0;
 
     for(size_t i = 0; i < iterations; i++)
     {
 
-        const NoddySparseGrid<char>& sg = *source_grid_ptr;
-        NoddySparseGrid<char>& dg = *dest_grid_ptr;
+        const Grid& sg = *source_grid_ptr;
+        Grid& dg = *dest_grid_ptr;
 
         resource_value = run_one_step(sg, dg);
         std::swap(source_grid_ptr, dest_grid_ptr);
@@ -107,66 +166,83 @@ size_t day18_solve_part1(size_t iterations, const NoddySparseGrid<char>& initial
     return resource_value;
 }
 
-size_t day18_solve_part2(const NoddySparseGrid<char>& initial_grid)
+size_t resource_value(const Grid& g)
 {
-    constexpr size_t end_iteration = 1000000000ull;
-    constexpr size_t skip_start = 1000ull;
-
-    NoddySparseGrid<char> grid1 = initial_grid;
-    NoddySparseGrid<char> grid2;
-
-    NoddySparseGrid<char>* source_grid_ptr = &grid1;
-    NoddySparseGrid<char>* dest_grid_ptr = &grid2;
-
-    // run until we get a 'cycle' based on the resource value...
-    // this might give false +ives... but we might be lucky
-    std::unordered_map<size_t, size_t> resource_val_iteration;
-    std::unordered_map<size_t, size_t> iteration_resource_val;
-
-    auto found_cycle = resource_val_iteration.end();
+    size_t wooded = 0;
+    size_t lumber_yards = 0;
 
-    size_t i = 0;
-    while(found_cycle == resource_val_iteration.end())
+    for (size_t r = 0; r < g.rows(); ++r)
     {
-        const NoddySparseGrid<char>& sg = *source_grid_ptr;
-        NoddySparseGrid<char>& dg = *dest_grid_ptr;
+        const Grid::word_type* row = g.row(r);
+        for (size_t i = 0; i < g.words_per_row(); ++i)
+        {
+            wooded += __builtin_popcountll(row[i] & low_bits);
+            lumber_yards += __builtin_popcountll((row[i] >> 1) & low_bits);
+        }
+    }
 
-        size_t resource_value = run_one_step(sg, dg);
+    return wooded * lumber_yards;
+}
 
-        if (i >= skip_start) {
-            found_cycle = resource_val_iteration.find(resource_value);
-            if (found_cycle == resource_val_iteration.end()) {
-                resource_val_iteration[resource_value] = i;
-                iteration_resource_val[i] = resource_value;
-            }
+// fingerprint a whole grid, a word at a time
+struct GridHash
+{
+    uint64_t operator()(const Grid& g) const
+    {
+        uint64_t h = 0;
+        for (size_t r = 0; r < g.rows(); ++r)
+        {
+            const Grid::word_type* row = g.row(r);
+            for (size_t i = 0; i < g.words_per_row(); ++i) h = hash_combine(h, row[i]);
         }
-        std::swap(source_grid_ptr, dest_grid_ptr);
-        i++;
+        return h;
     }
+};
+
+size_t day18_solve_part2(const Grid& initial_grid)
+{
+    constexpr uint64_t end_iteration = 1000000000ull;
 
-    // where in the cycle
-    size_t cycle_start = found_cycle->second;
-    size_t cycle_length = i - cycle_start - 1;
+    // the landscape settles into a loop, so find it (by the whole grid) and skip to the end
+    auto step = [](const Grid& sg, Grid& dg) { run_one_step(sg, dg); };
 
-    size_t cycle_pos = (end_iteration - cycle_start - 1) % cycle_length;
-    size_t resource_value = iteration_resource_val[cycle_start + cycle_pos];
-    return resource_value;
+    Cycle cycle = find_cycle(initial_grid, step, GridHash());
+    return resource_value(state_at(initial_grid, step, cycle, end_iteration));
 }
 
 
-int main()
+class Day18Solver : public Solver
 {
-    auto file_text = read_file("input.txt");
-    assert(!file_text.empty());
+private:
+    Grid grid;
+
+public:
+    void parse(const std::string& dir) override
+    {
+        auto file_text = read_file(dir + "/input.txt");
+        assert(!file_text.empty());
+
+        auto lines = parse_lines(file_text);
+        assert(!lines.empty());
+
+        populate_grid(grid, lines);
+    }
+
+    std::string part1() override
+    {
+        return answer(day18_solve_part1(10, grid));
+    }
 
-    auto lines = parse_lines(file_text);
-    assert(!lines.empty());
+    std::string part2() override
+    {
+        return answer(day18_solve_part2(grid));
+    }
+};
 
-    NoddySparseGrid<char> grid('.');
-    populate_grid(grid, lines);
 
-    std::cout << day18_solve_part1(10, grid) << std::endl;
-    std::cout << day18_solve_part2(grid) << std::endl;
-    return 0;
+std::unique_ptr<Solver> make_solver()
+{
+    return std::make_unique<Day18Solver>();
 }
 
+}
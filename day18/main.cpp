@@ -0,0 +1,6 @@
+#include "day18.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day18", day18::make_solver, argc, argv);
+}
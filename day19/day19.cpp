@@ -1,82 +1,42 @@
+#include "day19.h"
+
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <iostream>
-#include <functional>
+#include <limits>
+#include <stdexcept>
 
 #include "../util/file_parsing.h"
 
 
+namespace day19
+{
+
 constexpr size_t RegisterCount = 6; // must be set before the include
 #include "../util/aoc_cpu.h"
 
 
-constexpr size_t ip_index = 4;
-
-
-const std::array<Instruction, 36> program {
-        std::bind(addi, std::placeholders::_1, 4, 16, 4),
-        std::bind(seti, std::placeholders::_1, 1, 9, 5),
-        std::bind(seti, std::placeholders::_1, 1, 5, 2),
-        std::bind(mulr, std::placeholders::_1, 5, 2, 1),
-        std::bind(eqrr, std::placeholders::_1, 1, 3, 1),
-        std::bind(addr, std::placeholders::_1, 1, 4, 4),
-        std::bind(addi, std::placeholders::_1, 4, 1, 4),
-        std::bind(addr, std::placeholders::_1, 5, 0, 0),
-        std::bind(addi, std::placeholders::_1, 2, 1, 2),
-        std::bind(gtrr, std::placeholders::_1, 2, 3, 1),
-        std::bind(addr, std::placeholders::_1, 4, 1, 4),
-        std::bind(seti, std::placeholders::_1, 2, 6, 4),
-        std::bind(addi, std::placeholders::_1, 5, 1, 5),
-        std::bind(gtrr, std::placeholders::_1, 5, 3, 1),
-        std::bind(addr, std::placeholders::_1, 1, 4, 4),
-        std::bind(seti, std::placeholders::_1, 1, 2, 4),
-        std::bind(mulr, std::placeholders::_1, 4, 4, 4),
-        std::bind(addi, std::placeholders::_1, 3, 2, 3),
-        std::bind(mulr, std::placeholders::_1, 3, 3, 3),
-        std::bind(mulr, std::placeholders::_1, 4, 3, 3),
-        std::bind(muli, std::placeholders::_1, 3, 11, 3),
-        std::bind(addi, std::placeholders::_1, 1, 5, 1),
-        std::bind(mulr, std::placeholders::_1, 1, 4, 1),
-        std::bind(addi, std::placeholders::_1, 1, 2, 1),
-        std::bind(addr, std::placeholders::_1, 3, 1, 3),
-        std::bind(addr, std::placeholders::_1, 4, 0, 4),
-        std::bind(seti, std::placeholders::_1, 0, 2, 4),
-        std::bind(setr, std::placeholders::_1, 4, 8, 1),
-        std::bind(mulr, std::placeholders::_1, 1, 4, 1),
-        std::bind(addr, std::placeholders::_1, 4, 1, 1),
-        std::bind(mulr, std::placeholders::_1, 4, 1, 1),
-        std::bind(muli, std::placeholders::_1, 1, 14, 1),
-        std::bind(mulr, std::placeholders::_1, 1, 4, 1),
-        std::bind(addr, std::placeholders::_1, 3, 1, 3),
-        std::bind(seti, std::placeholders::_1, 0, 0, 0),
-        std::bind(seti, std::placeholders::_1, 0, 2, 4)
-};
-
-void run_until_halt(Registers& r, RegisterType& ip)
+void run_until_halt(const ElfProgram& program, Registers& r, RegisterType& ip)
 {
-    while (ip >= 0 && ip < program.size())
-    {
-        r[ip_index] = ip;
-        program[ip](r);
-        ip = r[ip_index];
-        ++ip;
-    }
+    run_program(program.instructions, program.ip_register, r, ip);
 }
 
 
-RegisterType day19_solve_part1()
+RegisterType day19_solve_part1(const ElfProgram& program)
 {
     Registers registers{};
     RegisterType ip = 0;
 
-    run_until_halt(registers, ip);
+    run_until_halt(program, registers, ip);
 
     return registers[0];
 }
 
-size_t day19_solve_part2()
+size_t day19_solve_part2(const ElfProgram& program)
 {
     // For the 2nd part, this program is:
-    //   initialisation to:
+    //   initialisation (A00 jumps to it, and it jumps back to A01) to:
     //     r0 = 0
     //     r1 = 10550400
     //     r2 = 0
@@ -95,7 +55,19 @@ size_t day19_solve_part2()
     //     while(r5 <= r3)
     //     HALT
     // Which effectively sums the integer divisors of 10551348 together (including 1 and 10551348)
-    size_t r3 = 10551348;
+    //
+    // The number is different for each input, so run the initialisation to get it: it's the biggest thing in
+    // the registers when the ip comes back to A01
+    Registers registers{};
+    registers[0] = 1;
+    RegisterType ip = 0;
+
+    run_program(program.instructions, program.ip_register, registers, ip,
+                [](const Registers&, RegisterType cip, size_t ni) { return cip == 1 && ni > 0; });
+    if (ip != 1 || program.instructions.size() <= 1) throw std::runtime_error("Program halted before getting back to A01");
+
+    registers[program.ip_register] = 0;
+    const auto r3 = static_cast<size_t>(*std::max_element(registers.begin(), registers.end()));
     size_t r0 = 0;
     for (size_t i = 1; i<= r3; i++)
     {
@@ -106,10 +78,32 @@ size_t day19_solve_part2()
 }
 
 
-int main()
+class Day19Solver : public Solver
 {
-    std::cout << day19_solve_part1() << std::endl;
-    std::cout << day19_solve_part2() << std::endl;
-    return 0;
+private:
+    ElfProgram program;
+
+public:
+    void parse(const std::string& dir) override
+    {
+        program = load_elfcode(read_file(dir + "/input.txt"));
+    }
+
+    std::string part1() override
+    {
+        return answer(day19_solve_part1(program));
+    }
+
+    std::string part2() override
+    {
+        return answer(day19_solve_part2(program));
+    }
+};
+
+
+std::unique_ptr<Solver> make_solver()
+{
+    return std::make_unique<Day19Solver>();
 }
 
+}
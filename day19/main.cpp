@@ -0,0 +1,6 @@
+#include "day19.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day19", day19::make_solver, argc, argv);
+}
@@ -1,12 +1,18 @@
+#include "day20.h"
+
 #include <cassert>
 #include <fstream>
 #include <iostream>
-#include <deque>
-#include <unordered_set>
+#include <limits>
 
 #include "../util/file_parsing.h"
+#include "../util/flat_hash.h"
 #include "../util/grid.h"
+#include "../util/search.h"
+
 
+namespace day20
+{
 
 enum direction
 {
@@ -57,11 +63,12 @@ void move_by_direction(direction d, int& x, int& y)
     }
 }
 
-size_t scan_subexpression(const std::string& tape, size_t start_pos)
-{
-    // memoise - assumes we always have the same tape!
-    static std::unordered_map<size_t, size_t> memos;
+// where each subexpression on a tape ends, by where it starts
+typedef FlatHashMap<size_t, size_t> ScanMemos;
 
+size_t scan_subexpression(const std::string& tape, size_t start_pos, ScanMemos& memos)
+{
+    // memoise - the memos must only ever be used with this tape!
     auto iter = memos.find(start_pos);
     if (iter != memos.end()) return iter->second;
 
@@ -76,7 +83,7 @@ size_t scan_subexpression(const std::string& tape, size_t start_pos)
 
             while (true)
             {
-                pos = scan_subexpression(tape, pos);
+                pos = scan_subexpression(tape, pos, memos);
                 if (tape[pos] == '|') { ++pos; continue; }
                 if (tape[pos] == ')') { ++pos; break; }
 
@@ -102,7 +109,7 @@ struct Walker
     };
 };
 
-void walk_next(const std::string& tape, Walker walker, const std::function<void(const Walker& from, const Walker& to, direction d)>& did_walk, const std::function<void(const Walker& new_walker)>& add_walker)
+void walk_next(const std::string& tape, ScanMemos& memos, Walker walker, const std::function<void(const Walker& from, const Walker& to, direction d)>& did_walk, const std::function<void(const Walker& new_walker)>& add_walker)
 {
     // skip the initial token
     if (walker.pos == 0 && tape[walker.pos] == '^') walker.pos++;
@@ -146,7 +153,7 @@ void walk_next(const std::string& tape, Walker walker, const std::function<void(
             add_walker({scanpos, walker.x, walker.y});
 
             // scan for the end of this expression
-            scanpos = scan_subexpression(tape, scanpos);
+            scanpos = scan_subexpression(tape, scanpos, memos);
 
             // two cases '|' or ')'
             if (tape[scanpos] == '|') { ++scanpos; continue; }  // skip after the '|', start a walker after
@@ -161,7 +168,7 @@ void walk_next(const std::string& tape, Walker walker, const std::function<void(
         // keep skipping the other alternatives until we hit the close
 
         size_t scanpos = walker.pos;
-        while(tape[scanpos] == '|') scanpos = scan_subexpression(tape, scanpos + 1);
+        while(tape[scanpos] == '|') scanpos = scan_subexpression(tape, scanpos + 1, memos);
 
         assert(tape[scanpos] == ')');    // should always hit the end of the alternative expression!
         ++scanpos;
@@ -177,21 +184,32 @@ void walk_next(const std::string& tape, Walker walker, const std::function<void(
 }
 
 
+}
+
+
 namespace std
 {
-    template<> struct hash<Walker>
+    template<> struct hash<day20::Walker>
     {
-        size_t operator()(const Walker& p) const noexcept
+        size_t operator()(const day20::Walker& p) const noexcept
         {
-            constexpr size_t m = 24251;     // a prime...
-            return std::hash<size_t>()(p.pos) + (std::hash<int>()(p.x) * m) + (std::hash<int>()(p.y) * m * m);
+            return hash_combine(hash_mix(p.pos), pack_ints(p.x, p.y));
         }
     };
 }
 
 
-using Grid = OriginCenteredGrid<std::array<bool, dirMax>>;
-using DistGrid = OriginCenteredGrid<size_t>;
+namespace day20
+{
+
+
+// the doors out of each room, as a bit per direction
+using Grid = PagedGrid<uint8_t>;
+
+uint8_t door_bit(direction d)
+{
+    return static_cast<uint8_t>(1u << d);
+}
 
 
 void walk_paths_to_make_map(const std::string& tape, Grid& grid)
@@ -199,20 +217,25 @@ void walk_paths_to_make_map(const std::string& tape, Grid& grid)
     // Walk the instructions on the tape, branching as needed
     // Branches *can* converge and overlap...
     // Keep a set of closed walkers so that convergences can be eliminated
-    std::unordered_set<Walker> closed;
-    std::unordered_set<Walker> open;
+    FlatHashSet<Walker> closed;
+    FlatHashSet<Walker> open;
     open.insert(Walker{});
 
+    // the starting room is always on the map, even when the tape has no moves at all
+    grid.at(0, 0);
+
+    ScanMemos memos;
+
     while(!open.empty())
     {
-        std::unordered_set<Walker> newly_open;
+        FlatHashSet<Walker> newly_open;
         for (const Walker& walker : open) {
             closed.insert(walker);
-            walk_next(tape, walker,
+            walk_next(tape, memos, walker,
                       [&](const Walker &from, const Walker &to, direction d) {
                           // add a door to the grid, for both directions
-                          grid[from.y][from.x][d] = true;
-                          grid[to.y][to.x][opposite_direction(d)] = true;
+                          grid[from.y][from.x] |= door_bit(d);
+                          grid[to.y][to.x] |= door_bit(opposite_direction(d));
                       },
                       [&](const Walker &new_walker) {
                           // add a new walker if this isn't already a tape-position and grid-position that's occured before
@@ -228,42 +251,49 @@ void walk_paths_to_make_map(const std::string& tape, Grid& grid)
 }
 
 
-void process_room_distances(const Grid& grid, DistGrid& dist_grid)
+// the rooms and their doors, as a graph for GraphSearch
+// (nodes number the cells in the grid's allocated pages, so the search's buffers only cover the parts of the map
+// that were walked, rather than its whole bounding box)
+struct RoomGraph
 {
-    std::deque<std::pair<size_t, Point>> open;
-    open.push_back({0, Point{0,0}});
+    typedef int cost_type;
 
-    Point furthest;
+    const Grid& grid;
 
-    while (!open.empty())
+    explicit RoomGraph(const Grid& g) : grid(g) {}
+
+    size_t node_of(int x, int y) const
     {
-        auto candidate = open.front();
-        open.pop_front();
+        return grid.cell_number(x, y);
+    }
 
+    size_t node_count() const
+    {
+        return grid.allocated_cell_count();
+    }
 
-        const size_t dist = candidate.first;
-        Point pos = candidate.second;
+    template<typename Emit>
+    void neighbours(size_t node, Emit&& emit) const
+    {
+        const Point p = grid.cell_at_number(node);
 
-        if (dist < dist_grid[pos])
+        const uint8_t doors = grid.at(p.x, p.y);
+        for (int di = 0; di < dirMax; ++di)
         {
-            // best (shortest) alternative so far
-            dist_grid[pos] = dist;
-
-            // add directions we can walk to the open set for next iteration
-            for (int di = 0; di < dirMax; ++di)
+            if (doors & door_bit(static_cast<direction>(di)))
             {
-                if (grid[pos][di])
-                {
-                    Point np = pos;
-                    move_by_direction(static_cast<direction>(di), np.x, np.y);
-
-                    if (dist + 1 < dist_grid[np]) open.emplace_back(dist + 1, np);
-                }
+                int nx = p.x;
+                int ny = p.y;
+                move_by_direction(static_cast<direction>(di), nx, ny);
+                emit(node_of(nx, ny), 1);   // (a room with a door is always in an allocated page)
             }
-
         }
     }
-}
+
+    cost_type heuristic(size_t) const { return 0; }
+    cost_type max_step_cost() const { return 1; }
+};
+
 
 std::pair<size_t, size_t> day20_solve_part1_and_2(const std::string& tape)
 {
@@ -273,51 +303,67 @@ std::pair<size_t, size_t> day20_solve_part1_and_2(const std::string& tape)
     Grid grid;
     walk_paths_to_make_map(tape, grid);
 
-    // now just do a simple dijkstra-like flood to find the room furthest away
-    constexpr size_t not_visited = std::numeric_limits<size_t>::max();
-
-    DistGrid dist_grid(not_visited);
-    process_room_distances(grid, dist_grid);
-
-    // scan for the (visited) room with the furthest distance
+    // now just do a simple BFS flood to find the room furthest away
     // also count the number of rooms at least 1000 distance away
     constexpr size_t far_distance = 1000;
 
-    Point furthest;
     size_t furthest_dist = 0;
     size_t far_room_count = 0;
-    for (auto y = dist_grid.min_row(); y <= dist_grid.max_row(); ++y)
+
+    const RoomGraph rooms(grid);
+    GraphSearch<RoomGraph> search;
+    search.run(rooms, rooms.node_of(0, 0), [&](size_t, int d) -> bool
     {
-        for (auto x = dist_grid.min_column(); x <= dist_grid.max_column(); ++x)
-        {
-            if (dist_grid[y][x] != not_visited)
-            {
-                if (furthest_dist < dist_grid[y][x]) {
-                    furthest_dist = dist_grid[y][x];
-                    furthest = Point(x, y);
-                }
+        size_t dist = size_t(d);
+        furthest_dist = std::max(furthest_dist, dist);
+        if (dist >= far_distance) ++far_room_count;
 
-                if (dist_grid[y][x] >= far_distance) ++far_room_count;
-            }
-        }
-    }
+        return true;
+    });
 
     return {furthest_dist, far_room_count};
 }
 
-int main()
+
+class Day20Solver : public Solver
 {
-    auto file_text = read_file("input.txt");
-    assert(!file_text.empty());
+private:
+    std::string tape;
+    std::pair<size_t, size_t> answers;
+
+public:
+    void parse(const std::string& dir) override
+    {
+        auto file_text = read_file(dir + "/input.txt");
+        assert(!file_text.empty());
+
+        auto lines = parse_lines(file_text);
+        assert(!lines.empty());
 
-    auto lines = parse_lines(file_text);
-    assert(!lines.empty());
+        tape = lines[0];
+    }
 
-    const std::string& tape = lines[0];
-    auto result = day20_solve_part1_and_2(tape);
+    std::string part1() override
+    {
+        answers = day20_solve_part1_and_2(tape);
+        return answer(answers.first);
+    }
 
-    std::cout << result.first << std::endl;
-    std::cout << result.second << std::endl;
-    return 0;
+    std::string part2() override
+    {
+        return answer(answers.second);
+    }
+
+    bool solves_parts_together() const override
+    {
+        return true;
+    }
+};
+
+
+std::unique_ptr<Solver> make_solver()
+{
+    return std::make_unique<Day20Solver>();
 }
 
+}
@@ -0,0 +1,6 @@
+#include "day20.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day20", day20::make_solver, argc, argv);
+}
@@ -1,75 +1,140 @@
+#include "day21.h"
+
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <iostream>
-#include <unordered_set>
+#include <limits>
+#include <stdexcept>
 
+#include "../util/cycle.h"
 #include "../util/file_parsing.h"
 
+
+namespace day21
+{
+
 constexpr size_t RegisterCount = 6; // must be set before the include
 #include "../util/aoc_cpu.h"
 
 
-constexpr size_t ip_index = 2;
-
-
-const std::array<Instruction, 32> program{
-        std::bind(seti, std::placeholders::_1, 123, 0, 5),
-        std::bind(bani, std::placeholders::_1, 5, 456, 5),
-        std::bind(eqri, std::placeholders::_1, 5, 72, 5),
-        std::bind(addr, std::placeholders::_1, 5, 2, 2),
-        std::bind(seti, std::placeholders::_1, 0, 0, 2),
-        std::bind(seti, std::placeholders::_1, 0, 9, 5),
-        std::bind(bori, std::placeholders::_1, 5, 65536, 3),
-        std::bind(seti, std::placeholders::_1, 7586220, 4, 5),
-        std::bind(bani, std::placeholders::_1, 3, 255, 1),
-        std::bind(addr, std::placeholders::_1, 5, 1, 5),
-        std::bind(bani, std::placeholders::_1, 5, 16777215, 5),
-        std::bind(muli, std::placeholders::_1, 5, 65899, 5),
-        std::bind(bani, std::placeholders::_1, 5, 16777215, 5),
-        std::bind(gtir, std::placeholders::_1, 256, 3, 1),
-        std::bind(addr, std::placeholders::_1, 1, 2, 2),
-        std::bind(addi, std::placeholders::_1, 2, 1, 2),
-        std::bind(seti, std::placeholders::_1, 27, 9, 2),
-        std::bind(seti, std::placeholders::_1, 0, 9, 1),
-        std::bind(addi, std::placeholders::_1, 1, 1, 4),
-        std::bind(muli, std::placeholders::_1, 4, 256, 4),
-        std::bind(gtrr, std::placeholders::_1, 4, 3, 4),
-        std::bind(addr, std::placeholders::_1, 4, 2, 2),
-        std::bind(addi, std::placeholders::_1, 2, 1, 2),
-        std::bind(seti, std::placeholders::_1, 25, 4, 2),
-        std::bind(addi, std::placeholders::_1, 1, 1, 1),
-        std::bind(seti, std::placeholders::_1, 17, 2, 2),
-        std::bind(setr, std::placeholders::_1, 1, 6, 3),
-        std::bind(seti, std::placeholders::_1, 7, 8, 2),
-        std::bind(eqrr, std::placeholders::_1, 5, 0, 1),
-        std::bind(addr, std::placeholders::_1, 1, 2, 2),
-        std::bind(seti, std::placeholders::_1, 5, 0, 2)
+// what the solution needs to know about the program
+struct HaltingProgram
+{
+    ElfProgram elf;
+
+    // the one place r0 is read: comparing it against the 'halter' register, halting if they're equal
+    RegisterType compare_ip = 0;
+    size_t halter = 0;
+
+    // the inner-loop that expensively does a right-shift by 8 (of n into t, using u), if there is one
+    bool has_shift_loop = false;
+    RegisterType shift_ip = 0;
+    size_t shift_t = 0, shift_u = 0, shift_n = 0;
 };
 
-using StateSet = std::unordered_set<Registers>;
 
-void run_until_halt_or_stopped(Registers& r, RegisterType& ip, const std::function<bool(const Registers&, const RegisterType&, size_t)>& stop_condition)
+// look for the inner-loop at ip:
+//     seti 0 _ t           t = 0
+//     addi t 1 u           do {
+//     muli u 256 u           u = (t + 1) * 256
+//     gtrr u n u             if (u > n) break
+//     addr u ip ip
+//     addi ip 1 ip
+//     seti ip+8 _ ip
+//     addi t 1 t             t += 1
+//     seti ip _ ip         } while(true)
+//     setr t _ n           n = t
+bool find_shift_loop(HaltingProgram& p, RegisterType ip)
+{
+    const auto& program = p.elf.instructions;
+    const auto ipr = static_cast<RegisterType>(p.elf.ip_register);
+    if (static_cast<size_t>(ip) + 10 > program.size()) return false;
+
+    auto is = [&](size_t offset, Op op, RegisterType a, RegisterType b, RegisterType c)
+    {
+        const DecodedInstruction& i = program[ip + offset];
+        return i.op == op && i.a == a && (b < 0 || i.b == b) && i.c == c;
+    };
+
+    const RegisterType t = program[ip].c;
+    const RegisterType u = program[ip + 1].c;
+    const RegisterType n = program[ip + 3].b;
+    if (t == ipr || u == ipr || n == ipr || t == u || t == n || u == n) return false;
+
+    const bool matches = is(0, Op::seti, 0, -1, t) &&
+                         is(1, Op::addi, t, 1, u) &&
+                         is(2, Op::muli, u, 256, u) &&
+                         is(3, Op::gtrr, u, n, u) &&
+                         is(4, Op::addr, u, ipr, ipr) &&
+                         is(5, Op::addi, ipr, 1, ipr) &&
+                         is(6, Op::seti, ip + 8, -1, ipr) &&
+                         is(7, Op::addi, t, 1, t) &&
+                         is(8, Op::seti, ip, -1, ipr) &&
+                         is(9, Op::setr, t, -1, n);
+    if (!matches) return false;
+
+    p.has_shift_loop = true;
+    p.shift_ip = ip;
+    p.shift_t = static_cast<size_t>(t);
+    p.shift_u = static_cast<size_t>(u);
+    p.shift_n = static_cast<size_t>(n);
+    return true;
+}
+
+HaltingProgram analyse_program(ElfProgram elf)
+{
+    HaltingProgram p;
+    p.elf = std::move(elf);
+
+    const auto& program = p.elf.instructions;
+    bool found_compare = false;
+    for (size_t ip = 0; ip < program.size(); ++ip)
+    {
+        const DecodedInstruction& i = program[ip];
+        if (i.op == Op::eqrr && (i.a == 0) != (i.b == 0))
+        {
+            if (found_compare) throw std::runtime_error("Program compares r0 more than once");
+
+            p.compare_ip = static_cast<RegisterType>(ip);
+            p.halter = static_cast<size_t>(i.a == 0 ? i.b : i.a);
+            found_compare = true;
+        }
+
+        if (!p.has_shift_loop) find_shift_loop(p, static_cast<RegisterType>(ip));
+    }
+    if (!found_compare) throw std::runtime_error("Program never compares r0 against anything");
+
+    return p;
+}
+
+
+template<typename StopCondition>
+void run_until_halt_or_stopped(const HaltingProgram& p, Registers& r, RegisterType& ip, StopCondition&& stop_condition)
 {
+    const auto& program = p.elf.instructions;
+    const size_t ip_index = p.elf.ip_register;
     size_t n_instructions = 0;
 
-    while (ip >= 0 && ip < program.size())
+    while (ip >= 0 && static_cast<size_t>(ip) < program.size())
     {
         if (stop_condition(r, ip, n_instructions)) break;
 
         r[ip_index] = ip;
 
         // shortcut for the inner-loop, that expensively does a right-shift!
-        if (ip==17)
+        if (p.has_shift_loop && ip == p.shift_ip && r[p.shift_n] >= 0)
         {
-            r[4] = 1;
-            r[1] = r[3] >> 8;
-            r[3] = r[1];
-            ip = 27;
+            r[p.shift_u] = 1;
+            r[p.shift_t] = r[p.shift_n] >> 8;
+            r[p.shift_n] = r[p.shift_t];
+            ip = p.shift_ip + 10;
 
-            n_instructions += (7 * r[1]) + 7;
+            n_instructions += (7 * r[p.shift_t]) + 7;
         }
         else
         {
-            program[ip](r);
+            execute(program[ip], r);
 
             ip = r[ip_index];
             ++ip;
@@ -79,55 +144,76 @@ void run_until_halt_or_stopped(Registers& r, RegisterType& ip, const std::functi
     }
 }
 
-int day21_solve_part1()
+int day21_solve_part1(const HaltingProgram& p)
 {
     Registers r{};
     RegisterType ip = 0;
 
-    run_until_halt_or_stopped(r, ip, [](const Registers& reg, const RegisterType& cip, size_t ni)->bool
+    run_until_halt_or_stopped(p, r, ip, [&](const Registers& reg, const RegisterType& cip, size_t ni)->bool
         {
-            return (cip==29);    // stop at the first attempted comparison with r0
+            return (cip==p.compare_ip);    // stop at the first attempted comparison with r0
         });
+    if (ip != p.compare_ip) throw std::runtime_error("Program halted without comparing r0");
 
-    return r[5];    // program will halt earliest if r0 == r5 at the first comparison
+    return r[p.halter];    // program will halt earliest if r0 == the halter at the first comparison
 }
 
-int day21_solve_part2()
+RegisterType next_halter(const HaltingProgram& p, RegisterType halter)
 {
+    // run from one comparison of r0 against the halter to the next
+    // the halter is the only register that's read before it's overwritten in between, so it's all the state there
+    // is (r0 is left at 0, so it never halts)
     Registers r{};
-    RegisterType ip = 0;
-
-    std::unordered_set<RegisterType> halters;
-    RegisterType last_halter = 0;
+    r[p.halter] = halter;
+    RegisterType ip = p.compare_ip;
 
-    run_until_halt_or_stopped(r, ip, [&halters, &last_halter](const Registers& reg, const RegisterType& cip, size_t ni)->bool
+    run_until_halt_or_stopped(p, r, ip, [&](const Registers& reg, const RegisterType& cip, size_t ni)->bool
     {
-        if (cip==29)
-        {
-//            std::cout << reg[5] << '\t' << ni << std::endl;
-
-            // the value in r[5] is a possible stopping condition for r0
-            // if it's the same as an existing value, then we're cycling and we should just stop!
-            auto insert_result = halters.insert(reg[5]);
-            if (!insert_result.second)
-            {
-                return true;
-            }
-
-            // keep the most recently inserted
-            last_halter = reg[5];
-        }
-
-        return false;
+        return cip==p.compare_ip && ni > 0;
     });
+    if (ip != p.compare_ip) throw std::runtime_error("Program halted without comparing r0 again");
+
+    return r[p.halter];
+}
+
+int day21_solve_part2(const HaltingProgram& p)
+{
+    // the values of the halter at the comparison are the possible stopping conditions for r0, and they go round in
+    // a loop - the last value before they start repeating is the one that takes longest to halt
+    const RegisterType first_halter = day21_solve_part1(p);
+    auto step = [&](RegisterType halter) { return next_halter(p, halter); };
 
-    return last_halter;
+    Cycle cycle = find_cycle(first_halter, step);
+    return state_at(first_halter, step, cycle, cycle.mu + cycle.lambda - 1);
 }
 
-int main()
+
+class Day21Solver : public Solver
+{
+private:
+    HaltingProgram program;
+
+public:
+    void parse(const std::string& dir) override
+    {
+        program = analyse_program(load_elfcode(read_file(dir + "/input.txt")));
+    }
+
+    std::string part1() override
+    {
+        return answer(day21_solve_part1(program));
+    }
+
+    std::string part2() override
+    {
+        return answer(day21_solve_part2(program));
+    }
+};
+
+
+std::unique_ptr<Solver> make_solver()
 {
-    std::cout << day21_solve_part1() << std::endl;
-    std::cout << day21_solve_part2() << std::endl;
-    return 0;
+    return std::make_unique<Day21Solver>();
 }
 
+}
@@ -0,0 +1,6 @@
+#include "day21.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day21", day21::make_solver, argc, argv);
+}
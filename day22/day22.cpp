@@ -1,17 +1,21 @@
+#include "day22.h"
+
 #include <cassert>
 #include <iostream>
-#include <queue>
-#include <unordered_set>
 
 #include "../util/file_parsing.h"
 #include "../util/grid.h"
+#include "../util/search.h"
+
+
+namespace day22
+{
 
 constexpr int depth = 3066;
 constexpr int targetx = 13;
 constexpr int targety = 726;
 
 
-
 enum CellType
 {
     cellRocky = 0,
@@ -31,7 +35,6 @@ char cell_to_char(CellType ct)
 }
 
 
-
 CellType cell_for_erosion_level(int el)
 {
     return static_cast<CellType>(el % 3);
@@ -63,7 +66,7 @@ int geologic_index_calc(int x, int y)
 int geologic_index(int x, int y)
 {
     constexpr int not_set = -1;
-    static NoddySparseGrid<int> memos(not_set);
+    static thread_local PagedGrid<int> memos(not_set);     // (per thread, in case of several solves at once)
 
     int& gi = memos[y][x];
     if (gi == not_set)
@@ -96,146 +99,150 @@ enum Equipped
 {
     equippedNone = 0,
     equippedTorch = 1,
-    equippedClimbing = 2
+    equippedClimbing = 2,
+
+    equippedMax = 3
 };
 
-bool operator==(const Point& a, const Point& b)
+// can only be using certain tools in certain types of cell:
+// no equipment on Rocky, no torch on Wet, no climbing stuff on Narrow
+// (which happens to be the tool with the same number as the cell type)
+bool can_use_in(Equipped e, uint8_t ct)
 {
-    return a.x == b.x && a.y == b.y;
+    return ct <= cellNarrow && static_cast<uint8_t>(e) != ct;
 }
 
-struct State
+
+// The cave around the mouth and the target, as a graph of (position, equipment) states for GraphSearch.
+// The cave goes on forever, so only a window of it is searched: 'pad' cells past the target in x and y.
+// Nodes are the cell index in a grid of the window's cell types, times equippedMax, plus the equipment.
+struct CaveGraph
 {
-    Point position;
-    Equipped equipped = equippedTorch;    // initial state is with the torch equipped
+    typedef int cost_type;
+
+    static constexpr uint8_t outside = 3;       // the halo around the window
+    static constexpr cost_type move_cost = 1;
+    static constexpr cost_type swap_cost = 7;
 
-    bool operator==(const State& o) const
+    DenseGrid<uint8_t> cells;
+    Point target;
+
+    CaveGraph(int pad, Point t) : cells(size_t(t.x + pad), size_t(t.y + pad), outside, 1), target(t)
     {
-        return position == o.position && equipped == o.equipped;
+        for (int y = 0; y < int(cells.rows()); ++y)
+        {
+            for (int x = 0; x < int(cells.columns()); ++x) cells[y][x] = static_cast<uint8_t>(cell_for_erosion_level(erosion_level(x, y)));
+        }
     }
-};
 
-struct TimedState
-{
-    State state;
-    int time = 0;
-};
+    // the cheapest any path that leaves the window could be:
+    // getting out to x (or y) and back to the target costs at least 2x - targetx + targety (or the same for y)
+    cost_type window_bound() const
+    {
+        return std::min(2 * int(cells.columns()) - target.x + target.y, 2 * int(cells.rows()) - target.y + target.x);
+    }
 
-struct QueuedState
-{
-    TimedState timedState;
-    int metric = 0;
+    size_t node_of(const Point& p, Equipped e) const
+    {
+        return cells.index_of(p) * equippedMax + e;
+    }
 
-    bool operator<(const QueuedState& other) const
+    size_t node_count() const
     {
-        // use >= so that 'lower' valued metrics are considered 'better' by the priq.
-        return metric >= other.metric;
+        return cells.cell_count() * equippedMax;
     }
-};
 
-namespace std
-{
-    template<> struct hash<State>
+    template<typename Emit>
+    void neighbours(size_t node, Emit&& emit) const
     {
-        size_t operator()(const State& p) const noexcept
+        const size_t cell = node / equippedMax;
+        const auto e = static_cast<Equipped>(node % equippedMax);
+        const size_t stride = cells.stride();
+
+        // We can go to any 4-connected cell in the window where we can use our equipment, cost of 1 minute
+        for (size_t next : {cell - 1, cell + 1, cell - stride, cell + stride})
         {
-            constexpr size_t m = 24251;
-            return (std::hash<Point>()(p.position) * m) + std::hash<int>()(static_cast<int>(p.equipped));
+            if (can_use_in(e, cells.at_index(next))) emit(next * equippedMax + e, move_cost);
         }
-    };
-}
 
+        // We can swap out our equipment for another that works here, cost of 7 minutes
+        for (int other = 0; other < equippedMax; ++other)
+        {
+            if (other != e && can_use_in(static_cast<Equipped>(other), cells.at_index(cell))) emit(cell * equippedMax + other, swap_cost);
+        }
+    }
 
-void try_enqueue(std::priority_queue<QueuedState>& queue, std::unordered_set<State>& closed, const TimedState& candidate)
-{
-    // only enqueue valid, non-closed states
-    const Point& p = candidate.state.position;
-    if (!p.is_positive()) return;  // was inaccessible rock
-    if (closed.end() != closed.find(candidate.state)) return;   // was closed
-
-    // can only be using certain tools in certain types of cell
-    CellType ct = cell_for_erosion_level( erosion_level(p.x, p.y));
-    switch(ct)
+    cost_type heuristic(size_t node) const
     {
-        default:
-            assert(false);
-        case cellRocky:
-            if (candidate.state.equipped == equippedNone) return;       // can't be using no equipment on Rocky
-            break;
-        case cellWet:
-            if (candidate.state.equipped == equippedTorch) return;      // can't be using torch on Wet
-            break;
-        case cellNarrow:
-            if (candidate.state.equipped == equippedClimbing) return;   // can't be using climbing stuff on Narrow
-            break;
+        // use a simple manhatten metric to estimate how much further to go
+        Point p = cells.point_at(node / equippedMax);
+        return std::abs(p.x - target.x) + std::abs(p.y - target.y);
     }
 
-    // if we've got this far, then we're a valid, open state... enqueue!
-
-    // use a simple manhatten metric to estimate how much further to go for this candidate
-    int dist = std::abs(p.x - targetx) + std::abs(p.y - targety);
-    int metric = dist + candidate.time;
-
-    QueuedState qs{candidate, metric};
-    queue.push(qs);
-}
+    cost_type max_step_cost() const
+    {
+        return swap_cost;
+    }
+};
 
-void enqueue_moves(std::priority_queue<QueuedState>& queue, std::unordered_set<State>& closed, const TimedState& source)
-{
-    // We can go to any +ive 4-connected ordinate, extra cost of 1 minute
-    const Point& p = source.state.position;
-
-    TimedState candidate = source;
-    ++candidate.time;
-
-    candidate.state.position = Point(p.x - 1, p.y); try_enqueue(queue, closed, candidate);
-    candidate.state.position = Point(p.x + 1, p.y); try_enqueue(queue, closed, candidate);
-    candidate.state.position = Point(p.x, p.y - 1); try_enqueue(queue, closed, candidate);
-    candidate.state.position = Point(p.x, p.y + 1); try_enqueue(queue, closed, candidate);
-
-    // We can swap out our equipment, extra cost of 7 minutes
-    candidate = source;
-    candidate.time += 7;
-    candidate.state.equipped = equippedNone; try_enqueue(queue, closed, candidate);
-    candidate.state.equipped = equippedTorch; try_enqueue(queue, closed, candidate);
-    candidate.state.equipped = equippedClimbing; try_enqueue(queue, closed, candidate);
-}
 
 int day22_solve_part2()
 {
-    std::unordered_set<State> closed;
-    std::priority_queue<QueuedState> queue;
-    queue.push(QueuedState());   // start at 0,0 with the torch out
-
-    State final_state{Point(targetx, targety), equippedTorch};
+    const Point target(targetx, targety);
+    GraphSearch<CaveGraph> search;
 
-    // while there are possible locations to search
-    while(!queue.empty())
+    // search with a window around the target, and widen it if the path found might not be the best
+    for (int pad = (targetx + targety) / 4; ; pad *= 2)
     {
-        // get the lowest metric candidate
-        const QueuedState qs = queue.top(); queue.pop();
-        const TimedState& candidate = qs.timedState;
+        const CaveGraph cave(pad, target);
+        const size_t final_state = cave.node_of(target, equippedTorch);
 
-        // add the candidate to the closed set
-        auto insert_result = closed.insert(candidate.state);
-        if (!insert_result.second) continue;    // if this is an already closed state, then skip it
+        int time = -1;
+        search.run(cave, cave.node_of(Point(0, 0), equippedTorch), [&](size_t node, int t) -> bool   // start at 0,0 with the torch out
+        {
+            // if this is our final state, then we're done!
+            if (node != final_state) return true;
 
-        // if this is our final state, then we're done!
-        if (candidate.state == final_state) return candidate.time;
+            time = t;
+            return false;
+        });
 
-        // otherwise, enqueue all non-closed permutations of our state
-        enqueue_moves(queue, closed, candidate);
-    }
+        assert(time >= 0);  // couldn't find a path at all?
 
-    assert(false);  // couldn't find a path at all?
-    return -1;
+        // any path leaving the window is at least this long, so if ours is no longer it's the best
+        if (time <= cave.window_bound()) return time;
+    }
 }
 
 
-int main()
+class Day22Solver : public Solver
+{
+public:
+    // the puzzle input is in the source, so there's no input directory to read
+    bool reads_input() const override
+    {
+        return false;
+    }
+
+    void parse(const std::string&) override
+    {
+    }
+
+    std::string part1() override
+    {
+        return answer(day22_solve_part1());
+    }
+
+    std::string part2() override
+    {
+        return answer(day22_solve_part2());
+    }
+};
+
+
+std::unique_ptr<Solver> make_solver()
 {
-    std::cout << day22_solve_part1() << std::endl;
-    std::cout << day22_solve_part2() << std::endl;
-    return 0;
+    return std::make_unique<Day22Solver>();
 }
 
+}
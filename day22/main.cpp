@@ -0,0 +1,6 @@
+#include "day22.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day22", day22::make_solver, argc, argv);
+}
@@ -1,14 +1,23 @@
+#include "day23.h"
+
 #include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <limits>
 #include <random>
-#include <sstream>
 
 #include "../util/file_parsing.h"
+#include "../util/format_scan.h"
+#include "../util/input_cache.h"
+#include "../util/parallel_parsing.h"
+#include "../util/point.h"
+
+
+namespace day23
+{
 
 using Ordinate = int64_t;
-using Point3d = std::array<Ordinate, 3>;
+using Point3d = PointN<3, Ordinate>;
 
 struct Bot
 {
@@ -16,34 +25,53 @@ struct Bot
     Ordinate r=0;
 };
 
-Bot parse_bot(const std::string& s)
+// the bots' positions a coordinate at a time, so they can all be measured against a point in one go
+struct BotSet
 {
-    std::stringstream ss(s);
-    Bot b;
+    PointsSoA<3, Ordinate> points;
+    std::vector<Ordinate> radii;
 
-    ss >> "pos=<" >> b.point[0] >> ',' >> b.point[1] >> ',' >> b.point[2] >> ">," >> "r=" >> b.r;
-    assert(ss);
+    explicit BotSet(const std::vector<Bot>& bots)
+    {
+        radii.reserve(bots.size());
+        for (const auto& b : bots)
+        {
+            points.push_back(b.point);
+            radii.push_back(b.r);
+        }
+    }
 
-    return b;
-}
+    // how many bots have p in range, using dists as scratch space
+    size_t count_in_range(const Point3d& p, std::vector<Ordinate>& dists) const
+    {
+        distances(p, points, dists);
 
+        size_t count = 0;
+        for (size_t i = 0; i < dists.size(); ++i) count += (dists[i] <= radii[i]);
+        return count;
+    }
+};
 
-Ordinate dist(const Point3d& a, const Point3d& b)
-{
-    return std::abs(a[0]-b[0]) + std::abs(a[1]-b[1]) + std::abs(a[2]-b[2]);
-}
+static constexpr char bot_format[] = "pos=<{},{},{}>, r={}";
 
-Ordinate dist_from_origin(const Point3d& a)
+Bot parse_bot(std::string_view s)
 {
-    return std::abs(a[0]) + std::abs(a[1]) + std::abs(a[2]);
+    Bot b;
+
+    scan_or_throw<bot_format>(s, b.point[0], b.point[1], b.point[2], b.r);
+
+    return b;
 }
 
 
 Ordinate day23_solve_part1(const std::vector<Bot>& bots)
 {
     const Bot& biggest_ranged_bot = *std::max_element(bots.begin(), bots.end(), [](const Bot& a, const Bot& b)->bool { return a.r < b.r; });
-    Ordinate count = std::count_if(bots.begin(), bots.end(), [&biggest_ranged_bot](const Bot& o)->bool{
-        Ordinate d = dist(o.point, biggest_ranged_bot.point);
+
+    std::vector<Ordinate> dists;
+    distances(biggest_ranged_bot.point, BotSet(bots).points, dists);
+
+    Ordinate count = std::count_if(dists.begin(), dists.end(), [&biggest_ranged_bot](Ordinate d)->bool{
         return d <= biggest_ranged_bot.r;
     });
 
@@ -73,11 +101,11 @@ Bounds compute_bounds(const std::vector<Bot>& bots)
     constexpr Ordinate omax = std::numeric_limits<Ordinate>::max();
 
     // find the min and max of the cuboid containing all the bots
-    Bounds bounds{{omax, omax, omax}, {omin, omin, omin}};
+    Bounds bounds{{{omax, omax, omax}}, {{omin, omin, omin}}};
 
     for(const auto b : bots)
     {
-        for(size_t i=0; i<bounds.min.size(); ++i)
+        for(size_t i=0; i<Point3d::dimensions; ++i)
         {
             bounds.min[i] = std::min(bounds.min[i], b.point[i]);
             bounds.max[i] = std::max(bounds.max[i], b.point[i]);
@@ -85,7 +113,7 @@ Bounds compute_bounds(const std::vector<Bot>& bots)
     }
 
     // set the range and max_range
-    for(size_t i=0; i<bounds.min.size(); ++i)
+    for(size_t i=0; i<Point3d::dimensions; ++i)
     {
         bounds.range[i] = bounds.max[i] - bounds.min[i] + 1;    // min/max is inclusive!
         bounds.max_range = std::max(bounds.max_range, bounds.range[i]);
@@ -108,7 +136,7 @@ struct Particle
         // pick a random point from our point within our step_size cube
         std::uniform_int_distribution<Ordinate> sd(-step_size, step_size);
 
-        return {{point[0]+sd(r.rnd), point[1]+sd(r.rnd), point[2]+sd(r.rnd)}, step_size};
+        return {{{point[0]+sd(r.rnd), point[1]+sd(r.rnd), point[2]+sd(r.rnd)}}, step_size};
     }
 
     bool operator<(const Particle& other)
@@ -122,8 +150,8 @@ struct Particle
         if (score == other.score)
         {
             // if the scores are the same, pick 'us' if we're nearer the origin
-            const Ordinate our_dist = dist_from_origin(point);
-            const Ordinate other_dist = dist_from_origin(other.point);
+            const Ordinate our_dist = manhattan_from_origin(point);
+            const Ordinate other_dist = manhattan_from_origin(other.point);
 
             return (our_dist < other_dist);
         }
@@ -143,26 +171,22 @@ void append_random_particles(ParticleVec& pv, size_t n, const Bounds& bounds, Ra
     const Ordinate step_size = bounds.max_range / 256;      // use an step size that's 'pretty big'
     for(size_t i = 0; i<n; ++i)
     {
-        Particle p{ {xd(r.rnd), yd(r.rnd), zd(r.rnd)}, step_size};
+        Particle p{ {{xd(r.rnd), yd(r.rnd), zd(r.rnd)}}, step_size};
         pv.push_back(p);
     }
 }
 
-void score_particle(Particle& p, const std::vector<Bot>& bots)
+void score_particle(Particle& p, const BotSet& bots, std::vector<Ordinate>& dists)
 {
     if (p.score >= 0) return;   // already scored
 
-    auto count = std::count_if(bots.begin(), bots.end(), [&p](const Bot& bot)->bool{
-        Ordinate d = dist(bot.point, p.point);
-        return d <= bot.r;
-    });
-
-    p.score = count;
+    p.score = bots.count_in_range(p.point, dists);
 }
 
-void score_particles(ParticleVec& pv, const std::vector<Bot>& bots)
+void score_particles(ParticleVec& pv, const BotSet& bots)
 {
-    for (auto& particle : pv) score_particle(particle, bots);
+    std::vector<Ordinate> dists;
+    for (auto& particle : pv) score_particle(particle, bots, dists);
 }
 
 void clone_particles(ParticleVec& pv, size_t n, Random& r)
@@ -183,6 +207,7 @@ Ordinate day23_solve_part2(const std::vector<Bot>& bots)
 {
     Random random;
     auto bounds = compute_bounds(bots);
+    const BotSet bot_set(bots);
 
     constexpr size_t n_particles = 2000;        // total number of particles
     constexpr size_t n_fresh_particles = 200;   // number of 'fresh' particles each iteration
@@ -196,7 +221,7 @@ Ordinate day23_solve_part2(const std::vector<Bot>& bots)
     append_random_particles(particles, n_particles, bounds, random);
 
     // set the initial scores and sort by score
-    score_particles(particles, bots);
+    score_particles(particles, bot_set);
     std::sort(particles.begin(), particles.end());
 
     Particle all_time_best = particles[0];
@@ -222,7 +247,7 @@ Ordinate day23_solve_part2(const std::vector<Bot>& bots)
         append_random_particles(particles, n_fresh_particles, bounds, random);
 
         // score the particles and sort by score
-        score_particles(particles, bots);
+        score_particles(particles, bot_set);
         std::sort(particles.begin(), particles.end());
 
         // check if we have any improvement
@@ -237,23 +262,46 @@ Ordinate day23_solve_part2(const std::vector<Bot>& bots)
         }
     }
 
-    return dist_from_origin(all_time_best.point);
+    return manhattan_from_origin(all_time_best.point);
 }
 
 
-int main()
+class Day23Solver : public Solver
 {
-    auto file_text = read_file("input.txt");
-    assert(!file_text.empty());
+private:
+    std::vector<Bot> bots;
 
-    auto lines = parse_lines(file_text);
-    assert(!lines.empty());
+public:
+    void parse(const std::string& dir) override
+    {
+        MappedFile input(dir + "/input.txt");
+        assert(!input.empty());
 
-    auto bots = convert_strings<Bot>(lines, parse_bot);
-    assert(!bots.empty());
+        bots = load_cached_records<Bot>(input.text(), "day23-bots", 1, [&]
+        {
+            auto lines = parse_lines_view(input.text());
+            assert(!lines.empty());
 
-    std::cout << day23_solve_part1(bots) << std::endl;
-    std::cout << day23_solve_part2(bots) << std::endl;
-    return 0;
+            return convert_strings_parallel<Bot>(lines, parse_bot);
+        });
+        assert(!bots.empty());
+    }
+
+    std::string part1() override
+    {
+        return answer(day23_solve_part1(bots));
+    }
+
+    std::string part2() override
+    {
+        return answer(day23_solve_part2(bots));
+    }
+};
+
+
+std::unique_ptr<Solver> make_solver()
+{
+    return std::make_unique<Day23Solver>();
 }
 
+}
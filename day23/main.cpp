@@ -0,0 +1,6 @@
+#include "day23.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day23", day23::make_solver, argc, argv);
+}
@@ -1,3 +1,5 @@
+#include "day24.h"
+
 #include <array>
 #include <algorithm>
 #include <cassert>
@@ -6,6 +8,10 @@
 #include <vector>
 #include <numeric>
 
+
+namespace day24
+{
+
 enum Force
 {
     frcImmuneSystem = 0,
@@ -148,7 +154,6 @@ DamageUnit potential_damage(const Group& attacker, const Group& defender)
 }
 
 
-
 bool target_selection_evaluation_order(const Group* const a, const Group* const b)
 {
     // run order is such that a before b if a has the bigger effective_power, then if the bigger initiative
@@ -285,10 +290,34 @@ DamageUnit day24_solve_part2(const GroupContainer& initial_groups)
 }
 
 
-int main()
+class Day24Solver : public Solver
 {
-    std::cout << day24_solve_part1(input_groups) << std::endl;
-    std::cout << day24_solve_part2(input_groups) << std::endl;
-    return 0;
+public:
+    // the puzzle input is in the source, so there's no input directory to read
+    bool reads_input() const override
+    {
+        return false;
+    }
+
+    void parse(const std::string&) override
+    {
+    }
+
+    std::string part1() override
+    {
+        return answer(day24_solve_part1(input_groups));
+    }
+
+    std::string part2() override
+    {
+        return answer(day24_solve_part2(input_groups));
+    }
+};
+
+
+std::unique_ptr<Solver> make_solver()
+{
+    return std::make_unique<Day24Solver>();
 }
 
+}
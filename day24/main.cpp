@@ -0,0 +1,6 @@
+#include "day24.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day24", day24::make_solver, argc, argv);
+}
@@ -1,119 +1,98 @@
+#include "day25.h"
+
 #include <array>
 #include <algorithm>
 #include <cassert>
 #include <iostream>
-#include <sstream>
-#include <unordered_set>
 #include <vector>
 
+#include "../util/disjoint_set.h"
 #include "../util/file_parsing.h"
+#include "../util/format_scan.h"
+#include "../util/input_cache.h"
+#include "../util/point.h"
+#include "../util/spatial_index.h"
 
-struct Point4d
-{
-    std::array<int, 4> v;
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
 
-    bool operator==(const Point4d& o) const { return v == o.v; }
-};
 
-namespace std
+namespace day25
 {
-    template<> struct hash<Point4d>
-    {
-        size_t operator()(const Point4d& p) const noexcept
-        {
-            constexpr size_t m = 24251;
-            size_t hash = 0;
-            for (auto v : p.v) hash = (hash*m) + std::hash<decltype(v)>()(v);
-            return hash;
-        }
-    };
-}
+
+using Point4d = PointN<4, int>;
 
 constexpr int constellation_range = 3;
 
-int dist(const Point4d& a, const Point4d& b)
-{
-    int dist = 0;
-    for (size_t i = 0; i<a.v.size(); ++i) dist += std::abs(a.v[i] - b.v[i]);
-    return dist;
-}
 
+static constexpr char p4d_format[] = "{},{},{},{}";
 
-Point4d parse_p4d(const std::string& s)
+Point4d parse_p4d(std::string_view s)
 {
     Point4d p{};
-    std::stringstream ss(s);
-    ss >> p.v[0] >> ',' >> p.v[1] >> ',' >> p.v[2] >> ',' >> p.v[3];
-    assert(ss);
+    scan_or_throw<p4d_format>(s, p[0], p[1], p[2], p[3]);
     return p;
 }
 
-bool is_point_in_constellation(const Point4d& point, const std::unordered_set<Point4d>& constellation)
-{
-    for (const auto& cp : constellation)
-    {
-        if (dist(point, cp) <= constellation_range) return true;
-    }
-    return false;
-}
-
 size_t day25_solve_part1(const std::vector<Point4d>& points)
 {
-    std::vector<std::unordered_set<Point4d>> constellations;
+    // points within range of each other are in the same constellation, so the constellations are the
+    // connected components - join each point to every point in range of it
+    const L1KdTree<4, int> point_tree(points);
+    ConcurrentDisjointSet constellations(points.size());
 
-    for(const auto& p : points)
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, points.size()), [&](const tbb::blocked_range<size_t>& range)
     {
-        // check if this point is in one (or more) existing constellations
-        // if it's in one constellation, insert it
-        // if it's in more than one, merge them together than insert it
-        auto first_found_constellation = constellations.end();
-        for (auto citer = constellations.begin(); citer != constellations.end(); ++citer)
+        for (size_t i = range.begin(); i < range.end(); ++i)
         {
-            auto inside = is_point_in_constellation(p, *citer);
-            if (!inside) continue;
-
-            if (first_found_constellation == constellations.end())
+            point_tree.within(points[i], constellation_range, [&](size_t j)
             {
-                // this is the first constellation this point is in
-                first_found_constellation = citer;
-                first_found_constellation->insert(p);
-            }
-            else
-            {
-                // this constellation is 'joined' to the first found constellation by the inserted point
-                // merge them into the first found, and empty this one
-                first_found_constellation->merge(*citer);
-                assert(citer->empty()); // all items should have been moved
-            }
+                if (j < i) constellations.unite(i, j);     // (each pair only needs joining once)
+            });
         }
+    });
 
-        // if this point wasn't in any constellation, make a new one
-        if (first_found_constellation == constellations.end())
-        {
-            constellations.emplace_back(std::unordered_set<Point4d>{p});
-        }
+    return constellations.set_count();
+}
 
-        // erase the empty constellations
-        constellations.erase( std::remove_if(constellations.begin(), constellations.end(), [](const auto& p){return p.empty(); }), constellations.end());
-    }
 
-    return constellations.size();
-}
+class Day25Solver : public Solver
+{
+private:
+    std::vector<Point4d> points;
 
+public:
+    void parse(const std::string& dir) override
+    {
+        MappedFile input(dir + "/input.txt");
+        assert(!input.empty());
 
+        points = load_cached_records<Point4d>(input.text(), "day25-points", 1, [&]
+        {
+            auto lines = parse_lines_view(input.text());
+            assert(!lines.empty());
 
-int main()
-{
-    auto file_text = read_file("input.txt");
-    assert(!file_text.empty());
+            return convert_strings<Point4d>(lines, parse_p4d);
+        });
+        assert(!points.empty());
+    }
 
-    auto lines = parse_lines(file_text);
-    assert(!lines.empty());
+    std::string part1() override
+    {
+        return answer(day25_solve_part1(points));
+    }
+
+    // the last day only has the one puzzle
+    std::string part2() override
+    {
+        return "";
+    }
+};
 
-    auto points = convert_strings<Point4d>(lines, parse_p4d);
-    assert(!points.empty());
 
-    std::cout << day25_solve_part1(points) << std::endl;
-    return 0;
+std::unique_ptr<Solver> make_solver()
+{
+    return std::make_unique<Day25Solver>();
 }
 
+}
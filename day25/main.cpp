@@ -0,0 +1,6 @@
+#include "day25.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day25", day25::make_solver, argc, argv);
+}
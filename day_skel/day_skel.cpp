@@ -1,8 +1,14 @@
+#include "day_skel.h"
+
 #include <cassert>
 #include <iostream>
 
 #include "../util/file_parsing.h"
 
+
+namespace day00
+{
+
 int day00_solve_part1()
 {
     return 0;
@@ -14,16 +20,36 @@ int day00_solve_part2()
 }
 
 
-int main()
+class Day00Solver : public Solver
 {
-    auto file_text = read_file("input.txt");
-    assert(!file_text.empty());
+private:
+    std::vector<std::string> lines;
 
-    auto lines = parse_lines(file_text);
-    assert(!lines.empty());
+public:
+    void parse(const std::string& dir) override
+    {
+        auto file_text = read_file(dir + "/input.txt");
+        assert(!file_text.empty());
 
-    std::cout << day00_solve_part1() << std::endl;
-    std::cout << day00_solve_part2() << std::endl;
-    return 0;
+        lines = parse_lines(file_text);
+        assert(!lines.empty());
+    }
+
+    std::string part1() override
+    {
+        return answer(day00_solve_part1());
+    }
+
+    std::string part2() override
+    {
+        return answer(day00_solve_part2());
+    }
+};
+
+
+std::unique_ptr<Solver> make_solver()
+{
+    return std::make_unique<Day00Solver>();
 }
 
+}
@@ -0,0 +1,6 @@
+#include "day_skel.h"
+
+int main(int argc, char* argv[])
+{
+    return run_solver("day00", day00::make_solver, argc, argv);
+}
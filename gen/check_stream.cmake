@@ -0,0 +1,29 @@
+# Checks a day gives the same answers with --stream as without, on a generated input that's bigger than one of
+# util/line_stream.h's chunks (so lines and tokens get split across chunk boundaries):
+#
+#     cmake -DGEN=<gen> -DDAY=<day binary> -DDAY_NUMBER=<n> -DSCALE=<scale> -DDIR=<scratch dir> -P check_stream.cmake
+
+set(chunk_size 1048576)     # ChunkReader::default_chunk_size
+
+file(MAKE_DIRECTORY ${DIR})
+execute_process(COMMAND ${GEN} ${DAY_NUMBER} ${SCALE} 1 ${DIR} RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "gen ${DAY_NUMBER} ${SCALE} failed")
+endif()
+
+file(READ ${DIR}/input.txt input)
+string(LENGTH "${input}" input_size)
+if(NOT input_size GREATER chunk_size)
+    message(FATAL_ERROR "The input is only ${input_size} bytes, which fits in one chunk")
+endif()
+
+execute_process(COMMAND ${DAY} WORKING_DIRECTORY ${DIR} OUTPUT_VARIABLE parsed RESULT_VARIABLE parsed_result)
+execute_process(COMMAND ${DAY} --stream WORKING_DIRECTORY ${DIR} OUTPUT_VARIABLE streamed RESULT_VARIABLE streamed_result)
+if(NOT parsed_result EQUAL 0 OR NOT streamed_result EQUAL 0)
+    message(FATAL_ERROR "The day failed (${parsed_result} parsed, ${streamed_result} streamed)")
+endif()
+
+if(NOT parsed STREQUAL streamed)
+    message(FATAL_ERROR "Parsed:\n${parsed}\nStreamed:\n${streamed}")
+endif()
+message(STATUS "Both gave:\n${parsed}")
@@ -0,0 +1,1194 @@
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+constexpr size_t RegisterCount = 4; // must be set before the include
+#include "../util/aoc_cpu.h"
+
+// Makes synthetic puzzle inputs for the days, at some multiple of the size of the real ones, so the solvers
+// can be benchmarked against bigger inputs than the ones in the repo.
+//
+//     gen <day> [scale] [seed] [output-dir]
+//
+// writes input.txt (and input_instrs.txt for day 16, or input_max_distance.txt for day 6) into output-dir, which
+// is where the days look for them:
+//
+//     mkdir -p /tmp/day03x100 && gen 3 100 1 /tmp/day03x100 && cd /tmp/day03x100 && day03 --bench
+//
+// Each generator keeps whatever the solver relies on about the real inputs (a single claim that overlaps nothing,
+// an acyclic set of steps, a well-formed tree, balanced parentheses, carts that all end up crashing...) and
+// scales the number of records by 'scale', growing the space they're spread over to keep the density the same.
+// The same day, scale and seed always give the same input, whichever standard library it's built with: the
+// standard distributions and std::shuffle are free to turn the same random numbers into different values on
+// each, so everything here is made straight from mt19937_64's output, which is the same everywhere.
+//
+// Days 9, 11, 14, 22 and 24 have their puzzle input built into the source, and don't read an input file (days 9,
+// 22 and 24 keep a copy of theirs as input.txt, but it's only for reference), so there isn't anything to generate
+// for them. Days 19 and 21 read an ElfCode program, and a random one of those wouldn't halt.
+
+
+typedef std::mt19937_64 Rng;
+typedef std::map<std::string, std::string> InputFiles;     // file name -> contents
+typedef std::function<InputFiles(Rng&, int)> Generator;
+
+
+// a number from lo to hi inclusive (taking the remainder is biased, but only by range / 2^64 - nothing here cares)
+uint64_t uniform_u64(Rng& rng, uint64_t lo, uint64_t hi)
+{
+    assert(lo <= hi);
+    const uint64_t range = hi - lo + 1;
+    const uint64_t x = rng();
+    return range == 0 ? x : lo + x % range;     // (a range of 0 is the whole 64 bits wrapping round)
+}
+
+int uniform(Rng& rng, int lo, int hi)
+{
+    assert(lo <= hi);
+    const uint64_t offset = uniform_u64(rng, 0, static_cast<uint64_t>(static_cast<int64_t>(hi) - lo));
+    return static_cast<int>(lo + static_cast<int64_t>(offset));
+}
+
+size_t uniform_size(Rng& rng, size_t lo, size_t hi)
+{
+    return static_cast<size_t>(uniform_u64(rng, lo, hi));
+}
+
+bool chance(Rng& rng, double p)
+{
+    // the top 53 bits, as a double in [0, 1)
+    return static_cast<double>(rng() >> 11) * (1.0 / 9007199254740992.0) < p;
+}
+
+// Fisher-Yates, as std::shuffle's results aren't the same from one standard library to the next
+template<typename Container>
+void shuffle(Container& c, Rng& rng)
+{
+    for (size_t i = c.size(); i > 1; --i)
+    {
+        using std::swap;
+        swap(c[i - 1], c[uniform_size(rng, 0, i - 1)]);
+    }
+}
+
+// grow a length by the scale's nth root, i.e. so an n-dimensional space gets 'scale' times bigger
+int scaled_extent(int extent, int scale, int n)
+{
+    return static_cast<int>(std::lround(extent * std::pow(scale, 1.0 / n)));
+}
+
+std::string join_lines(const std::vector<std::string>& lines)
+{
+    std::string s;
+    for (const auto& l : lines)
+    {
+        s += l;
+        s += '\n';
+    }
+    return s;
+}
+
+
+// frequency changes: the frequency jumps way up and climbs, then drops way down and climbs again to finish at the
+// drift (part 1). The drift is wider than either climb, so neither can repeat itself; what repeats is the second
+// climb, after it's been moved up by the drift enough times to land on the first - which is set up to take a
+// hundred or so times through the list, like the real ones.
+InputFiles gen_day01(Rng& rng, int scale)
+{
+    const int n = 959 * scale;
+
+    auto climb = [&rng](int count) -> std::vector<int>
+    {
+        std::vector<int> c{0};
+        while (c.size() < size_t(count)) c.push_back(c.back() + uniform(rng, 1, 19));
+        return c;
+    };
+
+    while (true)
+    {
+        const std::vector<int> first = climb(n / 2);
+        const std::vector<int> second = climb(n - n / 2);
+        const int span = std::max(first.back(), second.back());
+
+        // (kept small enough that the frequencies stay well inside an int, even at x1000)
+        const int drift = span + uniform(rng, 1, span / 4 + 1);
+        const int passes = uniform(rng, 80, 140);
+
+        // the second climb ends at the drift, and after 'passes' more passes it overlaps the top of the first
+        const int first_start = (passes + 1) * drift - second.back() / 2;
+        const int second_start = drift - second.back();
+
+        std::vector<int> frequencies{0};
+        for (int f : first) frequencies.push_back(first_start + f);
+        for (int f : second) frequencies.push_back(second_start + f);
+
+        // make sure the climbs do meet, so there's a repeat (they nearly always do)
+        std::set<int> first_set;
+        for (int f : first) first_set.insert(first_start + f);
+        const bool meets = std::any_of(second.begin(), second.end(), [&](int f)
+        {
+            return first_set.count(second_start + f + passes * drift) > 0;
+        });
+        if (!meets) continue;
+
+        std::ostringstream os;
+        for (size_t i = 1; i < frequencies.size(); ++i)
+        {
+            const int c = frequencies[i] - frequencies[i - 1];
+            os << (c > 0 ? "+" : "") << c << '\n';
+        }
+        return {{"input.txt", os.str()}};
+    }
+}
+
+
+// box ids, all mutations of one id, with exactly one pair that differ by a single letter
+InputFiles gen_day02(Rng& rng, int scale)
+{
+    const int n = 250 * scale;
+    const int length = 26;
+
+    std::string base(length, 'a');
+    for (auto& c : base) c = static_cast<char>('a' + uniform(rng, 0, 25));
+
+    std::set<std::string> seen;
+    std::vector<std::string> ids;
+    while (ids.size() < size_t(n - 1))
+    {
+        std::string id = base;
+        for (auto& c : id)
+        {
+            if (chance(rng, 0.6)) c = static_cast<char>('a' + uniform(rng, 0, 25));
+        }
+        if (seen.insert(id).second) ids.push_back(id);
+    }
+
+    // the near-match: a copy of one of the ids with one letter changed
+    std::string twin = ids[uniform(rng, 0, n - 2)];
+    int pos = uniform(rng, 0, length - 1);
+    twin[pos] = static_cast<char>('a' + (twin[pos] - 'a' + uniform(rng, 1, 25)) % 26);
+    ids.insert(ids.begin() + uniform(rng, 0, n - 1), twin);
+
+    return {{"input.txt", join_lines(ids)}};
+}
+
+
+// claims on the 1000x1000 fabric, only one of which overlaps no other
+// (the fabric stays the same size, so bigger inputs just pile up more claims)
+InputFiles gen_day03(Rng& rng, int scale)
+{
+    struct Rect { int x, y, w, h; };
+    const int fabric = 1000;
+    const int n = 1286 * scale;
+
+    auto random_rect = [&]() -> Rect
+    {
+        int w = uniform(rng, 10, 29);
+        int h = uniform(rng, 10, 29);
+        return {uniform(rng, 0, fabric - w), uniform(rng, 0, fabric - h), w, h};
+    };
+    auto overlaps = [](const Rect& a, const Rect& b) -> bool
+    {
+        return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+    };
+
+    const Rect lone = random_rect();
+    std::vector<Rect> claims;
+    while (claims.size() < size_t(n - 1))
+    {
+        Rect r = random_rect();
+        if (!overlaps(r, lone)) claims.push_back(r);
+    }
+
+    // every other claim has to overlap something - patch any that don't with a little claim on top of them
+    std::vector<int> count(fabric * fabric, 0);
+    for (const auto& r : claims)
+    {
+        for (int y = r.y; y < r.y + r.h; ++y)
+        {
+            for (int x = r.x; x < r.x + r.w; ++x) ++count[y * fabric + x];
+        }
+    }
+    const size_t n_claims = claims.size();
+    for (size_t i = 0; i < n_claims; ++i)
+    {
+        const Rect r = claims[i];
+        bool alone = true;
+        for (int y = r.y; alone && y < r.y + r.h; ++y)
+        {
+            for (int x = r.x; alone && x < r.x + r.w; ++x) alone = count[y * fabric + x] == 1;
+        }
+        if (alone) claims.push_back({r.x + uniform(rng, 0, r.w - 1), r.y + uniform(rng, 0, r.h - 1), 1, 1});
+    }
+
+    claims.push_back(lone);
+    shuffle(claims, rng);
+
+    std::ostringstream os;
+    for (size_t i = 0; i < claims.size(); ++i)
+    {
+        const auto& r = claims[i];
+        os << '#' << i + 1 << " @ " << r.x << ',' << r.y << ": " << r.w << 'x' << r.h << '\n';
+    }
+    return {{"input.txt", os.str()}};
+}
+
+
+// guard shifts, one per day, running on into the years after 1518 when there are too many for one year
+InputFiles gen_day04(Rng& rng, int scale)
+{
+    const int n_shifts = 287 * scale;
+    const int n_guards = 23 * scale;
+    const int month_days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+    std::set<int> guard_set;
+    while (guard_set.size() < size_t(n_guards)) guard_set.insert(uniform(rng, 10, 4000 * scale));
+    const std::vector<int> guards(guard_set.begin(), guard_set.end());
+
+    auto timestamp = [&](int day_index, int hour, int minute) -> std::string
+    {
+        int year = 1518 + day_index / 365;
+        int day = day_index % 365;
+        int month = 0;
+        while (day >= month_days[month]) day -= month_days[month++];
+
+        std::ostringstream ts;
+        ts << std::setfill('0') << '[' << year << '-' << std::setw(2) << month + 1 << '-' << std::setw(2) << day + 1
+           << ' ' << std::setw(2) << hour << ':' << std::setw(2) << minute << "] ";
+        return ts.str();
+    };
+
+    // some guards are sleepier than others
+    std::vector<int> most_naps(n_guards);
+    for (auto& m : most_naps) m = uniform(rng, 0, 4);
+
+    // and two of them stand out, each in their own way (so the two parts have different answers): one sleeps far
+    // more than anyone, in lots of naps all over the hour, and the other only takes a short nap each shift, but
+    // always over the same minute. They each get a few times as many shifts as the rest.
+    const int sleepiest = uniform(rng, 0, n_guards - 1);
+    int habitual = uniform(rng, 0, n_guards - 2);
+    if (habitual >= sleepiest) ++habitual;
+    const int habitual_minute = uniform(rng, 10, 54);
+    const double standout_share = std::min(0.3, 4.0 / n_guards);
+
+    std::vector<std::string> lines;
+    for (int day = 1; day <= n_shifts; ++day)
+    {
+        // the guard turns up a little before midnight, or just after
+        int g = uniform(rng, 0, n_guards - 1);
+        if (chance(rng, standout_share)) g = sleepiest;
+        else if (chance(rng, standout_share)) g = habitual;
+
+        const int guard = guards[g];
+        if (chance(rng, 0.5)) lines.push_back(timestamp(day - 1, 23, uniform(rng, 45, 59)) + "Guard #" + std::to_string(guard) + " begins shift");
+        else lines.push_back(timestamp(day, 0, uniform(rng, 0, 3)) + "Guard #" + std::to_string(guard) + " begins shift");
+
+        // then has a few naps during the midnight hour
+        std::set<int> minutes;
+        if (g == habitual)
+        {
+            minutes.insert(uniform(rng, habitual_minute - 4, habitual_minute));
+            minutes.insert(uniform(rng, habitual_minute + 1, habitual_minute + 5));
+        }
+        else
+        {
+            const int naps = g == sleepiest ? uniform(rng, 5, 8) : uniform(rng, 0, most_naps[g]);
+            while (minutes.size() < size_t(2 * naps)) minutes.insert(uniform(rng, 5, 59));
+        }
+
+        bool asleep = false;
+        for (int m : minutes)
+        {
+            lines.push_back(timestamp(day, 0, m) + (asleep ? "wakes up" : "falls asleep"));
+            asleep = !asleep;
+        }
+    }
+
+    shuffle(lines, rng);
+    return {{"input.txt", join_lines(lines)}};
+}
+
+
+// a polymer, built out of nested pairs of units that react away, with some that don't mixed in
+InputFiles gen_day05(Rng& rng, int scale)
+{
+    const size_t length = 50000 * size_t(scale);
+
+    auto random_unit = [&]() -> char
+    {
+        char c = static_cast<char>('a' + uniform(rng, 0, 25));
+        return chance(rng, 0.5) ? c : static_cast<char>(c - 'a' + 'A');
+    };
+    auto opposite = [](char c) -> char
+    {
+        return static_cast<char>(c ^ 0x20);     // swap the case
+    };
+
+    std::string polymer;
+    std::vector<char> open;
+    while (polymer.size() < length)
+    {
+        if (!open.empty() && chance(rng, 0.45))
+        {
+            polymer += opposite(open.back());
+            open.pop_back();
+        }
+        else if (chance(rng, 0.95))
+        {
+            open.push_back(random_unit());
+            polymer += open.back();
+        }
+        else polymer += random_unit();
+    }
+
+    return {{"input.txt", polymer + "\n"}};
+}
+
+
+// distinct coordinates, spread over a bigger square the more there are. Part 2 wants a region where the distances
+// to all of them add up to less than 10000, but with 'scale' times the points over a square sqrt(scale) times the
+// side, the sums come out scale^1.5 times bigger - so the threshold is scaled by as much, and written out to
+// input_max_distance.txt for the solver. That keeps the whole thing the same shape as the real one, just bigger.
+InputFiles gen_day06(Rng& rng, int scale)
+{
+    const int n = 50 * scale;
+    const int side = scaled_extent(320, scale, 2);
+    const int64_t max_total_distance = std::llround(10000 * std::pow(scale, 1.5));
+
+    const int lo = 40;
+    const int hi = lo + side;
+    const int mid = (lo + hi) / 2;
+
+    while (true)
+    {
+        std::set<std::pair<int, int>> seen;
+        std::vector<std::pair<int, int>> points;
+        while (points.size() < size_t(n))
+        {
+            int x = uniform(rng, lo, hi);
+            int y = uniform(rng, lo, hi);
+            if (seen.insert({x, y}).second) points.push_back({x, y});
+        }
+
+        // make sure the middle's in the region (it nearly always is)
+        int64_t total = 0;
+        for (const auto& p : points) total += std::abs(p.first - mid) + std::abs(p.second - mid);
+        if (total >= max_total_distance) continue;
+
+        std::ostringstream os;
+        for (const auto& p : points) os << p.first << ", " << p.second << '\n';
+        return {{"input.txt", os.str()}, {"input_max_distance.txt", std::to_string(max_total_distance) + "\n"}};
+    }
+}
+
+
+// step dependencies, which always go forwards in some random order of the steps so there are no cycles
+// (the steps are single letters, so there can only be 26 of them - scaling just adds more dependencies,
+// up to every step depending on every step before it)
+InputFiles gen_day07(Rng& rng, int scale)
+{
+    const int n_steps = 26;
+    const int n_edges = std::min(101 * scale, n_steps * (n_steps - 1) / 2);
+
+    std::string order(n_steps, 'A');
+    for (int i = 0; i < n_steps; ++i) order[i] = static_cast<char>('A' + i);
+    shuffle(order, rng);
+
+    std::set<std::pair<int, int>> edges;
+    for (int i = 1; i < n_steps; ++i) edges.insert({uniform(rng, 0, i - 1), i});     // so every step is used
+    while (edges.size() < size_t(n_edges))
+    {
+        int a = uniform(rng, 0, n_steps - 1);
+        int b = uniform(rng, 0, n_steps - 1);
+        if (a != b) edges.insert({std::min(a, b), std::max(a, b)});
+    }
+
+    std::vector<std::string> lines;
+    for (const auto& e : edges)
+    {
+        lines.push_back(std::string("Step ") + order[e.first] + " must be finished before step " + order[e.second] + " can begin.");
+    }
+    shuffle(lines, rng);
+    return {{"input.txt", join_lines(lines)}};
+}
+
+
+// a well-formed tree of nodes, written out as headers, children then metadata
+void write_tree_node(Rng& rng, std::ostream& os, size_t n_nodes)
+{
+    assert(n_nodes > 0);
+
+    // share out the nodes under this one between some children
+    std::vector<size_t> children;
+    size_t remaining = n_nodes - 1;
+    if (remaining > 0)
+    {
+        const size_t n_children = size_t(uniform(rng, 1, int(std::min<size_t>(remaining, 8))));
+        std::vector<size_t> cuts;
+        for (size_t i = 0; i + 1 < n_children; ++i) cuts.push_back(uniform_size(rng, 1, remaining - 1));
+        cuts.push_back(0);
+        cuts.push_back(remaining);
+        std::sort(cuts.begin(), cuts.end());
+
+        for (size_t i = 1; i < cuts.size(); ++i)
+        {
+            if (cuts[i] > cuts[i - 1]) children.push_back(cuts[i] - cuts[i - 1]);
+        }
+    }
+
+    const int n_metadata = uniform(rng, 1, 11);
+    os << children.size() << ' ' << n_metadata << ' ';
+    for (size_t c : children) write_tree_node(rng, os, c);
+    // (a node with children mostly points at them, and always at one of them first, as otherwise part 2's root
+    // tends to be worth nothing at all)
+    const int highest = children.empty() ? 9 : std::min(9, int(children.size()) + 1);
+    for (int i = 0; i < n_metadata; ++i)
+    {
+        const bool to_a_child = i == 0 && !children.empty();
+        os << uniform(rng, 1, to_a_child ? int(children.size()) : highest) << ' ';
+    }
+}
+
+InputFiles gen_day08(Rng& rng, int scale)
+{
+    std::ostringstream os;
+    write_tree_node(rng, os, 2000 * size_t(scale));
+
+    std::string s = os.str();
+    s.back() = '\n';
+    return {{"input.txt", s}};
+}
+
+
+// points of light, which come together at some time to spell out a row of (made up) letters
+InputFiles gen_day10(Rng& rng, int scale)
+{
+    const int n_letters = 8 * scale;
+    const int time = uniform(rng, 10000, 11000);
+    const int x0 = uniform(rng, 100, 200);
+    const int y0 = uniform(rng, 100, 200);
+
+    // letters are 6x10 strokes, like a segment display: the left side, plus some of the others
+    std::set<std::pair<int, int>> lit;
+    for (int l = 0; l < n_letters; ++l)
+    {
+        const int lx = x0 + l * 8;
+        for (int y = 0; y < 10; ++y) lit.insert({lx, y0 + y});
+
+        for (int y : {0, 4, 9})
+        {
+            if (!chance(rng, 0.6)) continue;
+            for (int x = 0; x < 6; ++x) lit.insert({lx + x, y0 + y});
+        }
+        for (int half = 0; half < 2; ++half)
+        {
+            if (!chance(rng, 0.6)) continue;
+            for (int y = half * 5; y < half * 5 + 5; ++y) lit.insert({lx + 5, y0 + y});
+        }
+    }
+
+    std::vector<std::string> lines;
+    for (const auto& p : lit)
+    {
+        int dx = 0, dy = 0;
+        while (dx == 0 && dy == 0)
+        {
+            dx = uniform(rng, -5, 5);
+            dy = uniform(rng, -5, 5);
+        }
+
+        std::ostringstream os;
+        os << "position=<" << std::setw(6) << p.first - dx * time << ", " << std::setw(6) << p.second - dy * time
+           << "> velocity=<" << std::setw(2) << dx << ", " << std::setw(2) << dy << '>';
+        lines.push_back(os.str());
+    }
+    shuffle(lines, rng);
+    return {{"input.txt", join_lines(lines)}};
+}
+
+
+// a row of pots, with rules for the traffic automaton (rule 184, or its mirror image): every plant moves one pot
+// along each generation unless there's a plant in the way. Jams always clear, so whatever the start, the plants
+// end up all spread out and moving at the same speed - the same shape every generation, as part 2 needs.
+InputFiles gen_day12(Rng& rng, int scale)
+{
+    const int n_pots = 100 * scale;
+    const bool rightwards = chance(rng, 0.5);
+
+    std::string pots(n_pots, '.');
+    for (auto& p : pots)
+    {
+        if (chance(rng, 0.4)) p = '#';
+    }
+
+    std::ostringstream os;
+    os << "initial state: " << pots << "\n\n";
+    for (int rule = 0; rule < 32; ++rule)
+    {
+        std::string pattern(5, '.');
+        for (int i = 0; i < 5; ++i)
+        {
+            if (rule & (1 << (4 - i))) pattern[i] = '#';
+        }
+
+        const bool behind = pattern[rightwards ? 1 : 3] == '#';
+        const bool here = pattern[2] == '#';
+        const bool ahead = pattern[rightwards ? 3 : 1] == '#';
+        const bool plant = (behind && !here) || (here && ahead);
+        os << pattern << " => " << (plant ? '#' : '.') << '\n';
+    }
+    return {{"input.txt", os.str()}};
+}
+
+
+// the day 13 tracks are squares of 150x150 tiles, each a tangle of overlapping loops with its own carts on them
+namespace tracks
+{
+    const int tile_size = 150;
+    const int dx[4] = {0, 1, 0, -1};     // up, right, down, left
+    const int dy[4] = {-1, 0, 1, 0};
+
+    struct Cart
+    {
+        int x, y, d;
+        int turn = -1;
+        bool crashed = false;
+    };
+
+    // add a loop, if it only crosses other loops on their straight parts
+    bool try_add_loop(std::vector<std::string>& tile, int x0, int y0, int x1, int y1)
+    {
+        std::vector<std::pair<std::pair<int, int>, char>> pieces;
+        for (int x = x0; x <= x1; ++x)
+        {
+            pieces.push_back({{x, y0}, x == x0 ? '/' : x == x1 ? '\\' : '-'});
+            pieces.push_back({{x, y1}, x == x0 ? '\\' : x == x1 ? '/' : '-'});
+        }
+        for (int y = y0 + 1; y < y1; ++y)
+        {
+            pieces.push_back({{x0, y}, '|'});
+            pieces.push_back({{x1, y}, '|'});
+        }
+
+        for (const auto& p : pieces)
+        {
+            char c = tile[p.first.second][p.first.first];
+            if (c == ' ') continue;
+            if ((p.second == '-' && c == '|') || (p.second == '|' && c == '-')) continue;
+            return false;
+        }
+
+        for (const auto& p : pieces)
+        {
+            char& c = tile[p.first.second][p.first.first];
+            c = (c == ' ') ? p.second : '+';
+        }
+        return true;
+    }
+
+    std::vector<std::string> make_tile(Rng& rng)
+    {
+        std::vector<std::string> tile(tile_size, std::string(tile_size, ' '));
+
+        int loops = 0;
+        for (int attempt = 0; attempt < 3000 && loops < 100; ++attempt)
+        {
+            int w = uniform(rng, 4, 100);
+            int h = uniform(rng, 4, 100);
+            int x0 = uniform(rng, 0, tile_size - 1 - w);
+            int y0 = uniform(rng, 0, tile_size - 1 - h);
+            if (try_add_loop(tile, x0, y0, x0 + w, y0 + h)) ++loops;
+        }
+        return tile;
+    }
+
+    // run the carts the same way day 13 does, and see if they crash down to 'survivors' carts in good time
+    bool settles(const std::vector<std::string>& tile, std::vector<Cart> carts, size_t survivors)
+    {
+        for (int tick = 0; tick < 50000; ++tick)
+        {
+            std::sort(carts.begin(), carts.end(), [](const Cart& a, const Cart& b) { return a.y < b.y || (a.y == b.y && a.x < b.x); });
+
+            bool crashed = false;
+            for (auto& c : carts)
+            {
+                if (c.crashed) continue;
+
+                c.x += dx[c.d];
+                c.y += dy[c.d];
+                switch (tile[c.y][c.x])
+                {
+                    case '/': c.d = (c.d == 0 || c.d == 2) ? c.d + 1 : c.d - 1; break;
+                    case '\\': c.d = 3 - c.d; break;
+                    case '+':
+                        c.d = (c.d + c.turn + 4) % 4;
+                        c.turn = c.turn == 1 ? -1 : c.turn + 1;
+                        break;
+                    default: break;
+                }
+
+                for (auto& o : carts)
+                {
+                    if (&o != &c && o.x == c.x && o.y == c.y) c.crashed = o.crashed = crashed = true;
+                }
+            }
+
+            if (crashed) carts.erase(std::remove_if(carts.begin(), carts.end(), [](const Cart& c) { return c.crashed; }), carts.end());
+            if (carts.size() <= survivors) return carts.size() == survivors;
+        }
+        return false;
+    }
+
+    std::vector<Cart> place_carts(Rng& rng, const std::vector<std::string>& tile, size_t n)
+    {
+        std::set<std::pair<int, int>> used;
+        std::vector<Cart> carts;
+        while (carts.size() < n)
+        {
+            int x = uniform(rng, 0, tile_size - 1);
+            int y = uniform(rng, 0, tile_size - 1);
+            char c = tile[y][x];
+            if ((c != '-' && c != '|') || !used.insert({x, y}).second) continue;
+
+            int d = (c == '|' ? 0 : 1) + (chance(rng, 0.5) ? 2 : 0);
+            carts.push_back({x, y, d});
+        }
+        return carts;
+    }
+}
+
+// every tile's carts crash away to nothing, apart from one tile which is left with a single cart for part 2
+InputFiles gen_day13(Rng& rng, int scale)
+{
+    using namespace tracks;
+
+    const int columns = static_cast<int>(std::ceil(std::sqrt(scale)));
+    const int rows = (scale + columns - 1) / columns;
+    const int stride = tile_size + 1;
+    const int last_tile = uniform(rng, 0, scale - 1);
+
+    std::vector<std::string> map(rows * stride, std::string(columns * stride, ' '));
+    for (int t = 0; t < scale; ++t)
+    {
+        const size_t survivors = (t == last_tile) ? 1 : 0;
+        const size_t n_carts = 16 + survivors;
+
+        std::vector<std::string> tile;
+        std::vector<Cart> carts;
+        for (bool done = false; !done; )
+        {
+            tile = make_tile(rng);
+            for (int attempt = 0; attempt < 50 && !done; ++attempt)
+            {
+                carts = place_carts(rng, tile, n_carts);
+                done = settles(tile, carts, survivors);
+            }
+        }
+
+        for (const auto& c : carts) tile[c.y][c.x] = "^>v<"[c.d];
+
+        const int ox = (t % columns) * stride;
+        const int oy = (t / columns) * stride;
+        for (int y = 0; y < tile_size; ++y) map[oy + y].replace(ox, tile_size, tile[y]);
+    }
+
+    for (auto& l : map) l.erase(l.find_last_not_of(' ') + 1);
+    return {{"input.txt", join_lines(map)}};
+}
+
+
+// a cave of open floor that's all joined up (so combat can always finish), with elves and goblins scattered over it
+InputFiles gen_day15(Rng& rng, int scale)
+{
+    const int size = scaled_extent(32, scale, 2);
+
+    std::vector<std::string> cave(size, std::string(size, '#'));
+    for (int y = 1; y < size - 1; ++y)
+    {
+        for (int x = 1; x < size - 1; ++x) cave[y][x] = chance(rng, 0.45) ? '#' : '.';
+    }
+
+    // smooth the noise into caverns
+    for (int pass = 0; pass < 4; ++pass)
+    {
+        auto next = cave;
+        for (int y = 1; y < size - 1; ++y)
+        {
+            for (int x = 1; x < size - 1; ++x)
+            {
+                int walls = 0;
+                for (int yy = y - 1; yy <= y + 1; ++yy)
+                {
+                    for (int xx = x - 1; xx <= x + 1; ++xx) walls += cave[yy][xx] == '#';
+                }
+                next[y][x] = walls >= 5 ? '#' : '.';
+            }
+        }
+        cave = std::move(next);
+    }
+
+    // keep only the biggest cavern
+    std::vector<int> component(size * size, -1);
+    std::vector<int> component_sizes;
+    for (int start = 0; start < size * size; ++start)
+    {
+        if (cave[start / size][start % size] != '.' || component[start] >= 0) continue;
+
+        const int id = int(component_sizes.size());
+        component_sizes.push_back(0);
+        std::vector<int> stack{start};
+        component[start] = id;
+        while (!stack.empty())
+        {
+            int i = stack.back();
+            stack.pop_back();
+            ++component_sizes[id];
+            for (int n : {i - 1, i + 1, i - size, i + size})
+            {
+                if (cave[n / size][n % size] == '.' && component[n] < 0)
+                {
+                    component[n] = id;
+                    stack.push_back(n);
+                }
+            }
+        }
+    }
+    assert(!component_sizes.empty());
+
+    const int biggest = int(std::max_element(component_sizes.begin(), component_sizes.end()) - component_sizes.begin());
+    std::vector<int> floor;
+    for (int i = 0; i < size * size; ++i)
+    {
+        if (component[i] == biggest) floor.push_back(i);
+        else cave[i / size][i % size] = '#';
+    }
+
+    // about one unit to every 12 squares of floor, one elf to every two goblins
+    shuffle(floor, rng);
+    const size_t n_units = std::max<size_t>(3, floor.size() / 12);
+    for (size_t u = 0; u < n_units; ++u) cave[floor[u] / size][floor[u] % size] = (u % 3 == 0) ? 'E' : 'G';
+
+    return {{"input.txt", join_lines(cave)}};
+}
+
+
+// samples of the mystery opcodes (enough to work out which is which), and a program for part 2
+InputFiles gen_day16(Rng& rng, int scale)
+{
+    auto run = [](int op, Registers& r, int a, int b, int c)
+    {
+        execute({static_cast<Op>(op), a, b, c}, r);
+    };
+
+    std::array<int, 16> opcode_of;
+    for (int i = 0; i < 16; ++i) opcode_of[i] = i;
+    shuffle(opcode_of, rng);
+
+    // samples, until there are enough and they pin down every opcode
+    std::array<std::bitset<16>, 16> candidates;
+    for (auto& c : candidates) c.set();
+
+    auto resolves = [&candidates]() -> bool
+    {
+        auto c = candidates;
+        for (int found = 0; found < 16; ++found)
+        {
+            auto known = std::find_if(c.begin(), c.end(), [](const std::bitset<16>& b) { return b.count() == 1; });
+            if (known == c.end()) return false;
+
+            const auto bit = *known;
+            for (auto& other : c) other &= ~bit;
+        }
+        return true;
+    };
+
+    std::ostringstream samples;
+    auto write_registers = [&samples](const Registers& r)
+    {
+        samples << '[' << r[0] << ", " << r[1] << ", " << r[2] << ", " << r[3] << "]\n";
+    };
+
+    const int n_samples = 792 * scale;
+    for (int i = 0; i < n_samples || !resolves(); ++i)
+    {
+        Registers before;
+        for (auto& r : before) r = uniform(rng, 0, 3);
+        const int op = uniform(rng, 0, 15);
+        const int a = uniform(rng, 0, 3), b = uniform(rng, 0, 3), c = uniform(rng, 0, 3);
+
+        Registers after = before;
+        run(op, after, a, b, c);
+
+        for (int other = 0; other < 16; ++other)
+        {
+            Registers r = before;
+            run(other, r, a, b, c);
+            if (r != after) candidates[opcode_of[op]].reset(other);
+        }
+
+        samples << "Before: ";
+        write_registers(before);
+        samples << opcode_of[op] << ' ' << a << ' ' << b << ' ' << c << '\n';
+        samples << "After:  ";
+        write_registers(after);
+        samples << '\n';
+    }
+
+    // the program: r0 (the answer) is only ever added to, so it depends on the whole program, and the other
+    // registers are kept small (instructions that would make them big are skipped) so nothing overflows
+    std::ostringstream program;
+    Registers regs{};
+    for (int i = 0; i < 841 * scale; )
+    {
+        int op = uniform(rng, 0, 15);
+        int a = uniform(rng, 0, 3), b = uniform(rng, 0, 3);
+        const int c = uniform(rng, 0, 3);
+        if (c == 0)
+        {
+            op = static_cast<int>(chance(rng, 0.5) ? Op::addr : Op::addi);
+            a = 0;
+            if (op == static_cast<int>(Op::addr)) b = uniform(rng, 1, 3);
+        }
+
+        Registers r = regs;
+        run(op, r, a, b, c);
+        if (c != 0 && r[c] > 1000) continue;
+
+        regs = r;
+        program << opcode_of[op] << ' ' << a << ' ' << b << ' ' << c << '\n';
+        ++i;
+    }
+
+    return {{"input.txt", samples.str()}, {"input_instrs.txt", program.str()}};
+}
+
+
+// clay veins under the spring at x=500: buckets for the water to fill, and lone walls and ledges for it to spill off
+InputFiles gen_day17(Rng& rng, int scale)
+{
+    const int half_width = scaled_extent(211, scale, 2);
+    const int max_y = scaled_extent(1841, scale, 2);
+    const int n_veins = 2130 * scale;
+
+    std::vector<std::string> lines;
+    auto vertical = [&lines](int x, int y0, int y1)
+    {
+        lines.push_back("x=" + std::to_string(x) + ", y=" + std::to_string(y0) + ".." + std::to_string(y1));
+    };
+    auto horizontal = [&lines](int y, int x0, int x1)
+    {
+        lines.push_back("y=" + std::to_string(y) + ", x=" + std::to_string(x0) + ".." + std::to_string(x1));
+    };
+
+    while (lines.size() < size_t(n_veins))
+    {
+        const int w = uniform(rng, 2, 28);
+        const int h = uniform(rng, 2, 28);
+        const int x = uniform(rng, 500 - half_width, 500 + half_width - w);
+        const int y = uniform(rng, 5, max_y - h);
+
+        if (chance(rng, 0.6))
+        {
+            vertical(x, y, y + h);
+            vertical(x + w, y, y + h);
+            horizontal(y + h, x, x + w);
+        }
+        else if (chance(rng, 0.5)) vertical(x, y, y + h);
+        else horizontal(y, x, x + w);
+    }
+
+    shuffle(lines, rng);
+    return {{"input.txt", join_lines(lines)}};
+}
+
+
+// a square of open ground, trees and lumberyards, in about the same mix as the real one
+InputFiles gen_day18(Rng& rng, int scale)
+{
+    const int size = scaled_extent(50, scale, 2);
+
+    std::vector<std::string> area(size, std::string(size, '.'));
+    for (auto& row : area)
+    {
+        for (auto& c : row)
+        {
+            int r = uniform(rng, 0, 9);
+            c = r < 6 ? '.' : r < 8 ? '|' : '#';
+        }
+    }
+    return {{"input.txt", join_lines(area)}};
+}
+
+
+// a regex of rooms: a random maze (a spanning tree of a square of rooms, dug out depth-first so it has long
+// winding corridors), written out the same way the real ones seem to be. Short dead ends come out as detours
+// that walk back on themselves, like (NEWS|), and other forks as a group of alternatives that finishes its
+// sequence - so branches never rejoin anywhere but where they started, and the walkers never multiply up.
+namespace rooms
+{
+    const int dx[4] = {0, 1, 0, -1};
+    const int dy[4] = {-1, 0, 1, 0};
+    const char dir_char[4] = {'N', 'E', 'S', 'W'};
+
+    struct Maze
+    {
+        int size = 0;
+        std::vector<int> parent;
+        std::vector<std::vector<int>> children;
+
+        char direction(int from, int to) const
+        {
+            for (int d = 0; d < 4; ++d)
+            {
+                if (to == from + dx[d] + dy[d] * size) return dir_char[d];
+            }
+            assert(false);
+            throw std::runtime_error("Rooms aren't next to each other");
+        }
+    };
+
+    Maze dig(Rng& rng, int size, int start)
+    {
+        Maze m;
+        m.size = size;
+        m.parent.assign(size * size, -1);
+        m.children.resize(size * size);
+
+        std::vector<bool> visited(size * size, false);
+        std::vector<int> stack{start};
+        visited[start] = true;
+        while (!stack.empty())
+        {
+            const int room = stack.back();
+            const int x = room % size, y = room / size;
+
+            std::vector<int> next;
+            for (int d = 0; d < 4; ++d)
+            {
+                const int nx = x + dx[d], ny = y + dy[d];
+                if (nx >= 0 && ny >= 0 && nx < size && ny < size && !visited[ny * size + nx]) next.push_back(ny * size + nx);
+            }
+
+            if (next.empty())
+            {
+                stack.pop_back();
+                continue;
+            }
+
+            const int n = next[uniform(rng, 0, int(next.size()) - 1)];
+            visited[n] = true;
+            m.parent[n] = room;
+            m.children[room].push_back(n);
+            stack.push_back(n);
+        }
+        return m;
+    }
+
+    // the directions down a dead end from 'from' to 'room', if it's only a few rooms long
+    bool short_dead_end(const Maze& m, int from, int room, std::string& path)
+    {
+        path = m.direction(from, room);
+        while (!m.children[room].empty())
+        {
+            if (m.children[room].size() > 1 || path.size() >= 3) return false;
+
+            path += m.direction(room, m.children[room][0]);
+            room = m.children[room][0];
+        }
+        return true;
+    }
+
+    std::string back_along(const std::string& path)
+    {
+        std::string back;
+        for (auto i = path.rbegin(); i != path.rend(); ++i) back += "SWNE"[std::string("NESW").find(*i)];
+        return back;
+    }
+
+    // (this walks the tree with its own stack, as a big maze is far too deep to recurse through)
+    std::string write_regex(const Maze& m, int start)
+    {
+        struct Fork
+        {
+            int room;
+            std::vector<int> branches;
+            size_t next = 0;
+        };
+        std::vector<Fork> forks;
+
+        std::string out = "^";
+        int room = start;
+        while (true)
+        {
+            // follow a sequence from room until it ends at a dead end, or splits
+            while (true)
+            {
+                std::vector<int> branches;
+                for (int c : m.children[room])
+                {
+                    std::string path;
+                    if (short_dead_end(m, room, c, path)) out += "(" + path + back_along(path) + "|)";
+                    else branches.push_back(c);
+                }
+
+                if (branches.empty()) break;
+                if (branches.size() == 1)
+                {
+                    out += m.direction(room, branches[0]);
+                    room = branches[0];
+                    continue;
+                }
+
+                out += '(';
+                out += m.direction(room, branches[0]);
+                forks.push_back({room, branches});
+                room = branches[0];
+            }
+
+            // then on to the next alternative of the innermost fork that has any left
+            while (!forks.empty() && forks.back().next + 1 == forks.back().branches.size())
+            {
+                out += ')';
+                forks.pop_back();
+            }
+            if (forks.empty()) break;
+
+            Fork& f = forks.back();
+            room = f.branches[++f.next];
+            out += '|';
+            out += m.direction(f.room, room);
+        }
+
+        return out + "$\n\n";
+    }
+}
+
+InputFiles gen_day20(Rng& rng, int scale)
+{
+    const int size = scaled_extent(100, scale, 2);
+    const int start = (size / 2) * size + size / 2;
+
+    return {{"input.txt", rooms::write_regex(rooms::dig(rng, size, start), start)}};
+}
+
+
+// nanobots, spread over the same sort of space as the real ones, most of them overlapping one spot
+InputFiles gen_day23(Rng& rng, int scale)
+{
+    const int n = 1000 * scale;
+
+    // like the real one, most of the bots (about 70% of them) share a spot that they all have in range, and the
+    // rest are scattered about - without one big overlap, the search for the best spot goes on and on
+    const int64_t centre[3] = {uniform(rng, 0, 150000000), uniform(rng, 0, 60000000), uniform(rng, 0, 100000000)};
+
+    std::ostringstream os;
+    for (int i = 0; i < n; ++i)
+    {
+        const int r = uniform(rng, 49975122, 99859637);
+
+        int64_t pos[3];
+        if (chance(rng, 0.7))
+        {
+            // somewhere well within r of the centre: split a distance of up to r/2 between the axes
+            const int d = uniform(rng, 0, r / 2);
+            int cuts[2] = {uniform(rng, 0, d), uniform(rng, 0, d)};
+            if (cuts[0] > cuts[1]) std::swap(cuts[0], cuts[1]);
+            const int parts[3] = {cuts[0], cuts[1] - cuts[0], d - cuts[1]};
+
+            for (int k = 0; k < 3; ++k) pos[k] = centre[k] + (chance(rng, 0.5) ? parts[k] : -parts[k]);
+        }
+        else
+        {
+            pos[0] = uniform(rng, -86417218, 245576225);
+            pos[1] = uniform(rng, -76528417, 134434422);
+            pos[2] = uniform(rng, -51892699, 162995214);
+        }
+
+        os << "pos=<" << pos[0] << ',' << pos[1] << ',' << pos[2] << ">, r=" << r << '\n';
+    }
+    return {{"input.txt", os.str()}};
+}
+
+
+// points in 4d, over a bigger hypercube the more there are
+InputFiles gen_day25(Rng& rng, int scale)
+{
+    const int n = 1483 * scale;
+    const int extent = scaled_extent(8, scale, 4);
+
+    std::ostringstream os;
+    for (int i = 0; i < n; ++i)
+    {
+        for (int d = 0; d < 4; ++d) os << (d ? "," : "") << uniform(rng, -extent, extent);
+        os << '\n';
+    }
+    return {{"input.txt", os.str()}};
+}
+
+
+const std::map<int, Generator> generators
+        {
+                {1, gen_day01}, {2, gen_day02}, {3, gen_day03}, {4, gen_day04}, {5, gen_day05},
+                {6, gen_day06}, {7, gen_day07}, {8, gen_day08}, {10, gen_day10}, {12, gen_day12},
+                {13, gen_day13}, {15, gen_day15}, {16, gen_day16}, {17, gen_day17}, {18, gen_day18},
+                {20, gen_day20}, {23, gen_day23}, {25, gen_day25}
+        };
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argc > 5)
+    {
+        std::cerr << "usage: " << argv[0] << " <day> [scale] [seed] [output-dir]" << std::endl;
+        return 1;
+    }
+
+    const int day = std::atoi(argv[1]);
+    const int scale = argc > 2 ? std::atoi(argv[2]) : 1;
+    const unsigned long seed = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1;
+    const std::string dir = argc > 4 ? argv[4] : ".";
+
+    auto g = generators.find(day);
+    if (g == generators.end())
+    {
+        std::cerr << "no generator for day " << argv[1] << " (days 9, 11, 14, 22 and 24 don't read an input file, and 19 and 21 read a program)" << std::endl;
+        return 1;
+    }
+    if (scale < 1)
+    {
+        std::cerr << "scale should be a whole number, at least 1" << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        Rng rng(seed);
+        for (const auto& f : g->second(rng, scale))
+        {
+            std::ofstream out(dir + "/" + f.first, std::ios::binary);
+            out << f.second;
+            if (!out) throw std::runtime_error("Couldn't write " + dir + "/" + f.first);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "gen: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
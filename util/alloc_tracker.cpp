@@ -0,0 +1,174 @@
+#include "alloc_tracker.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+
+namespace alloc_detail
+{
+    ThreadCounters& this_thread_counters()
+    {
+        static thread_local ThreadCounters counters;   // (trivial, so no guard or constructor to run)
+        return counters;
+    }
+
+    // Every block has a header in front of it with its size (for the counts when it's freed - unsized
+    // deletes don't tell us) and the header's own length (bigger for over-aligned blocks, to keep them aligned).
+    constexpr size_t default_header = 2 * sizeof(size_t);
+    static_assert(default_header % alignof(std::max_align_t) == 0, "the header must keep malloc's alignment");
+
+    void* allocate(size_t size, size_t alignment)
+    {
+        const size_t header = alignment > default_header ? alignment : default_header;
+
+        void* raw;
+        if (alignment > alignof(std::max_align_t))
+        {
+            // aligned_alloc wants the size to be a multiple of the alignment
+            const size_t total = (size + header + alignment - 1) / alignment * alignment;
+            raw = std::aligned_alloc(alignment, total);
+        }
+        else
+        {
+            raw = std::malloc(size + header);
+        }
+        if (raw == nullptr) return nullptr;
+
+        auto block = static_cast<size_t*>(static_cast<void*>(static_cast<char*>(raw) + header));
+        block[-1] = size;
+        block[-2] = header;
+
+        auto& counters = this_thread_counters();
+        ++counters.allocations;
+        counters.bytes += size;
+        counters.live_bytes += static_cast<int64_t>(size);
+        if (counters.live_bytes > counters.peak_bytes) counters.peak_bytes = counters.live_bytes;
+
+        return block;
+    }
+
+    void deallocate(void* p)
+    {
+        if (p == nullptr) return;
+
+        auto block = static_cast<size_t*>(p);
+        const size_t size = block[-1];
+        const size_t header = block[-2];
+
+        this_thread_counters().live_bytes -= static_cast<int64_t>(size);
+
+        std::free(static_cast<char*>(p) - header);
+    }
+
+    void* allocate_or_throw(size_t size, size_t alignment)
+    {
+        void* p = allocate(size, alignment);
+        if (p == nullptr) throw std::bad_alloc();
+        return p;
+    }
+}
+
+
+// the replacements for the global allocation functions, all going through the counted allocate/deallocate
+
+void* operator new(size_t size)
+{
+    return alloc_detail::allocate_or_throw(size, alignof(std::max_align_t));
+}
+
+void* operator new[](size_t size)
+{
+    return alloc_detail::allocate_or_throw(size, alignof(std::max_align_t));
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return alloc_detail::allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return alloc_detail::allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    return alloc_detail::allocate_or_throw(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    return alloc_detail::allocate_or_throw(size, static_cast<size_t>(alignment));
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return alloc_detail::allocate(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return alloc_detail::allocate(size, static_cast<size_t>(alignment));
+}
+
+
+void operator delete(void* p) noexcept
+{
+    alloc_detail::deallocate(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    alloc_detail::deallocate(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    alloc_detail::deallocate(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    alloc_detail::deallocate(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    alloc_detail::deallocate(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    alloc_detail::deallocate(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    alloc_detail::deallocate(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+    alloc_detail::deallocate(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept
+{
+    alloc_detail::deallocate(p);
+}
+
+void operator delete[](void* p, size_t, std::align_val_t) noexcept
+{
+    alloc_detail::deallocate(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    alloc_detail::deallocate(p);
+}
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    alloc_detail::deallocate(p);
+}
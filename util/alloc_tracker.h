@@ -0,0 +1,85 @@
+//
+// Created by wuggy on 17/10/26.
+//
+
+#ifndef AOC2018_ALLOC_TRACKER_H
+#define AOC2018_ALLOC_TRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Counting of heap allocations, to see how much each solver (or bit of one) allocates.
+//
+// alloc_tracker.cpp replaces the global operator new/delete, so anything linked with aoc_util is counted.
+// The counts are kept per thread, with no locking:
+//
+//     AllocRegion region;
+//     ... do something ...
+//     AllocStats stats = region.stats();   // allocations, bytes and the high-water mark since region started
+//
+// Only the calling thread's allocations count towards a region - work handed off to TBB workers isn't
+// included. Memory freed on a different thread to the one that allocated it makes the first thread's live
+// bytes go up and the second's go down, so high-water marks are only meaningful for single-threaded code.
+
+
+struct AllocStats
+{
+    uint64_t allocations = 0;   // number of calls to operator new
+    uint64_t bytes = 0;         // total bytes asked for by those calls
+    int64_t peak_bytes = 0;     // the most live bytes there were at any one time, over those live at the start
+};
+
+
+namespace alloc_detail
+{
+    // a thread's running totals. These are plain (and zero initialised) so that operator new can use them
+    // from any thread at any time, even before main
+    struct ThreadCounters
+    {
+        uint64_t allocations;
+        uint64_t bytes;
+        int64_t live_bytes;
+        int64_t peak_bytes;
+    };
+
+    ThreadCounters& this_thread_counters();
+}
+
+
+// a scope to measure the allocations in. Regions can nest.
+class AllocRegion
+{
+private:
+    alloc_detail::ThreadCounters start;
+
+public:
+    AllocRegion() : start(alloc_detail::this_thread_counters())
+    {
+        // track the high-water mark from here, putting the outer one back when we're done
+        auto& counters = alloc_detail::this_thread_counters();
+        counters.peak_bytes = counters.live_bytes;
+    }
+
+    ~AllocRegion()
+    {
+        auto& counters = alloc_detail::this_thread_counters();
+        if (start.peak_bytes > counters.peak_bytes) counters.peak_bytes = start.peak_bytes;
+    }
+
+    AllocRegion(const AllocRegion&) = delete;
+    AllocRegion& operator=(const AllocRegion&) = delete;
+
+    AllocStats stats() const
+    {
+        const auto& counters = alloc_detail::this_thread_counters();
+
+        AllocStats s;
+        s.allocations = counters.allocations - start.allocations;
+        s.bytes = counters.bytes - start.bytes;
+        s.peak_bytes = counters.peak_bytes - start.live_bytes;
+        return s;
+    }
+};
+
+
+#endif //AOC2018_ALLOC_TRACKER_H
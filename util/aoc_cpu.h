@@ -5,76 +5,345 @@
 #ifndef AOC2018_AOC_CPU_H
 #define AOC2018_AOC_CPU_H
 
+// The wrist device's CPU, for days 16, 19 and 21. Include this inside the day's namespace, after setting
+// RegisterCount (and after including <algorithm>, <array>, <limits>, <stdexcept>, <string>, <string_view> and
+// <vector>).
+//
+// Instructions are decoded into a flat DecodedInstruction - the op as a byte, then its three operands - and
+// executed by a switch on the op, so stepping through a program is a jump through a table with the operands
+// right there, rather than a call through a std::function to a std::bind holding them.
+//
+// ElfCode programs (days 19 and 21) are loaded from their text with load_elfcode(), see below.
+
 using RegisterType = int;
 
 using Registers = std::array<RegisterType, RegisterCount>;
-using Instruction = std::function<void(Registers&)>;        // usually made with std::bind on an InstructionFunc
-using InstructionFunc = std::function<void(Registers&, RegisterType, RegisterType, RegisterType)>;
 
-template<typename OpType>
-void inst_r(Registers& r, RegisterType a, RegisterType b, RegisterType c)
+
+// the 16 ops, 'r' operands being registers and 'i' ones immediate values
+enum class Op : unsigned char
 {
-    r[c] = OpType()(r[a], r[b]);
-}
+    addr, addi,
+    mulr, muli,
+    banr, bani,
+    borr, bori,
+    setr, seti,
+    gtir, gtri, gtrr,
+    eqir, eqri, eqrr
+};
+
+constexpr size_t OpCount = 16;
+
+// the ops' mnemonics, in the same order
+constexpr std::array<std::string_view, OpCount> op_names
+        {
+                "addr", "addi",
+                "mulr", "muli",
+                "banr", "bani",
+                "borr", "bori",
+                "setr", "seti",
+                "gtir", "gtri", "gtrr",
+                "eqir", "eqri", "eqrr"
+        };
 
-template<typename OpType>
-void inst_i(Registers& r, RegisterType a, RegisterType b, RegisterType c)
+// whether an op reads its a (or b) operand as a register, rather than using it as a value
+// (setr and seti ignore b altogether - it can be anything)
+inline bool reads_register_a(Op op)
 {
-    r[c] = OpType()(r[a], b);
+    return op != Op::seti && op != Op::gtir && op != Op::eqir;
 }
 
-auto addr = inst_r<std::plus<RegisterType>>;
-auto addi = inst_i<std::plus<RegisterType>>;
+inline bool reads_register_b(Op op)
+{
+    switch (op)
+    {
+        case Op::addr: case Op::mulr: case Op::banr: case Op::borr:
+        case Op::gtir: case Op::gtrr: case Op::eqir: case Op::eqrr:
+            return true;
+        default:
+            return false;
+    }
+}
 
-auto mulr = inst_r<std::multiplies<RegisterType>>;
-auto muli = inst_i<std::multiplies<RegisterType>>;
 
-auto banr = inst_r<std::bit_and<RegisterType>>;
-auto bani = inst_i<std::bit_and<RegisterType>>;
+struct DecodedInstruction
+{
+    Op op;
+    RegisterType a;
+    RegisterType b;
+    RegisterType c;
+};
 
-auto borr = inst_r<std::bit_or<RegisterType>>;
-auto bori = inst_i<std::bit_or<RegisterType>>;
 
-void setr(Registers& r, RegisterType a, RegisterType b, RegisterType c)
+// the arithmetic is done unsigned, so that it wraps (day 21 multiplies well past the range of an int, and
+// relies on keeping just the low bits)
+inline RegisterType wrapping_add(RegisterType x, RegisterType y)
 {
-    r[c] = r[a];
+    return static_cast<RegisterType>(static_cast<unsigned>(x) + static_cast<unsigned>(y));
 }
 
-void seti(Registers& r, RegisterType a, RegisterType b, RegisterType c)
+inline RegisterType wrapping_mul(RegisterType x, RegisterType y)
 {
-    r[c] = a;
+    return static_cast<RegisterType>(static_cast<unsigned>(x) * static_cast<unsigned>(y));
 }
 
 
-void gtir(Registers& r, RegisterType a, RegisterType b, RegisterType c)
+inline void execute(const DecodedInstruction& i, Registers& r)
 {
-    r[c] = (a > r[b]) ? 1 : 0;
+    switch (i.op)
+    {
+        case Op::addr: r[i.c] = wrapping_add(r[i.a], r[i.b]); break;
+        case Op::addi: r[i.c] = wrapping_add(r[i.a], i.b); break;
+
+        case Op::mulr: r[i.c] = wrapping_mul(r[i.a], r[i.b]); break;
+        case Op::muli: r[i.c] = wrapping_mul(r[i.a], i.b); break;
+
+        case Op::banr: r[i.c] = r[i.a] & r[i.b]; break;
+        case Op::bani: r[i.c] = r[i.a] & i.b; break;
+
+        case Op::borr: r[i.c] = r[i.a] | r[i.b]; break;
+        case Op::bori: r[i.c] = r[i.a] | i.b; break;
+
+        case Op::setr: r[i.c] = r[i.a]; break;
+        case Op::seti: r[i.c] = i.a; break;
+
+        case Op::gtir: r[i.c] = (i.a > r[i.b]) ? 1 : 0; break;
+        case Op::gtri: r[i.c] = (r[i.a] > i.b) ? 1 : 0; break;
+        case Op::gtrr: r[i.c] = (r[i.a] > r[i.b]) ? 1 : 0; break;
+
+        case Op::eqir: r[i.c] = (i.a == r[i.b]) ? 1 : 0; break;
+        case Op::eqri: r[i.c] = (r[i.a] == i.b) ? 1 : 0; break;
+        case Op::eqrr: r[i.c] = (r[i.a] == r[i.b]) ? 1 : 0; break;
+    }
 }
 
-void gtri(Registers& r, RegisterType a, RegisterType b, RegisterType c)
+
+// Run a program (any array of DecodedInstructions) from ip, until the ip leaves the program or
+// stop(registers, ip, instructions_run) says to stop before the instruction at ip.
+// The ip is bound to register ip_register: it's written there before each instruction and read back after.
+// Returns the number of instructions run.
+template<typename Program, typename StopCondition>
+size_t run_program(const Program& program, size_t ip_register, Registers& r, RegisterType& ip, StopCondition&& stop)
 {
-    r[c] = (r[a] > b) ? 1 : 0;
+    size_t n_instructions = 0;
+    while (ip >= 0 && static_cast<size_t>(ip) < program.size())
+    {
+        if (stop(r, ip, n_instructions)) break;
+
+        r[ip_register] = ip;
+        execute(program[ip], r);
+        ip = r[ip_register] + 1;
+
+        ++n_instructions;
+    }
+    return n_instructions;
 }
 
-void gtrr(Registers& r, RegisterType a, RegisterType b, RegisterType c)
+template<typename Program>
+size_t run_program(const Program& program, size_t ip_register, Registers& r, RegisterType& ip)
 {
-    r[c] = (r[a] > r[b]) ? 1 : 0;
+    return run_program(program, ip_register, r, ip, [](const Registers&, RegisterType, size_t) { return false; });
 }
 
 
-void eqir(Registers& r, RegisterType a, RegisterType b, RegisterType c)
+// A program loaded from ElfCode: a "#ip N" directive binding the ip to register N, then an instruction per line
+//
+//     #ip 2
+//     seti 123 0 5
+//     bani 5 456 5
+//
+// Anything after a ';' is a comment. Instructions can also be labelled with their address (A00, A01...),
+// in which case they can come in any order, and only the labelled lines count - the rest (and anything after
+// the operands) are notes, so a program can be written up with its workings alongside it.
+// Anything wrong (an unknown op, a register that doesn't exist, a missing or repeated address...) throws.
+struct ElfProgram
 {
-    r[c] = (a == r[b]) ? 1 : 0;
-}
+    size_t ip_register = 0;
+    std::vector<DecodedInstruction> instructions;
+};
 
-void eqri(Registers& r, RegisterType a, RegisterType b, RegisterType c)
+
+namespace elfcode_detail
 {
-    r[c] = (r[a] == b) ? 1 : 0;
+    inline std::vector<std::string_view> split_words(std::string_view line)
+    {
+        std::vector<std::string_view> words;
+        size_t pos = 0;
+        while (true)
+        {
+            pos = line.find_first_not_of(" \t\r", pos);
+            if (pos == std::string_view::npos) break;
+
+            size_t end = line.find_first_of(" \t\r", pos);
+            if (end == std::string_view::npos) end = line.size();
+
+            words.push_back(line.substr(pos, end - pos));
+            pos = end;
+        }
+        return words;
+    }
+
+    inline bool parse_number(std::string_view word, long& value)
+    {
+        size_t i = (!word.empty() && word[0] == '-') ? 1 : 0;
+        if (i == word.size()) return false;
+
+        value = 0;
+        for (; i < word.size(); ++i)
+        {
+            if (word[i] < '0' || word[i] > '9') return false;
+            value = value * 10 + (word[i] - '0');
+            if (value > (1L << 40)) return false;
+        }
+        if (word[0] == '-') value = -value;
+        return true;
+    }
+
+    inline bool parse_op(std::string_view word, Op& op)
+    {
+        for (size_t i = 0; i < OpCount; ++i)
+        {
+            if (op_names[i] == word)
+            {
+                op = static_cast<Op>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // an address label, like A07
+    inline bool parse_label(std::string_view word, long& address)
+    {
+        return word.size() > 1 && word[0] == 'A' && parse_number(word.substr(1), address) && address >= 0;
+    }
+
+    inline bool is_register(long value)
+    {
+        return value >= 0 && value < static_cast<long>(RegisterCount);
+    }
 }
 
-void eqrr(Registers& r, RegisterType a, RegisterType b, RegisterType c)
+
+inline ElfProgram load_elfcode(std::string_view text)
 {
-    r[c] = (r[a] == r[b]) ? 1 : 0;
+    using namespace elfcode_detail;
+
+    struct Line
+    {
+        size_t number;
+        std::vector<std::string_view> words;
+    };
+
+    // split it up, dropping comments and blank lines
+    std::vector<Line> lines;
+    size_t number = 0;
+    for (size_t start = 0; start < text.size(); )
+    {
+        size_t end = text.find('\n', start);
+        if (end == std::string_view::npos) end = text.size();
+
+        std::string_view line = text.substr(start, end - start);
+        line = line.substr(0, line.find(';'));
+        start = end + 1;
+        ++number;
+
+        auto words = split_words(line);
+        if (!words.empty()) lines.push_back({number, std::move(words)});
+    }
+
+    auto fail = [](size_t line_number, const std::string& what)
+    {
+        throw std::runtime_error("ElfCode line " + std::to_string(line_number) + ": " + what);
+    };
+
+    // a labelled program is one with any line that starts with a label and an op
+    auto is_labelled_instruction = [](const Line& l)
+    {
+        long address;
+        Op op;
+        return l.words.size() > 1 && parse_label(l.words[0], address) && parse_op(l.words[1], op);
+    };
+    const bool labelled = std::any_of(lines.begin(), lines.end(), is_labelled_instruction);
+
+    ElfProgram program;
+    bool seen_ip = false;
+    std::vector<bool> have_address;
+    for (const auto& l : lines)
+    {
+        const auto& words = l.words;
+
+        if (words[0] == "#ip")
+        {
+            long ip_register;
+            if (seen_ip) fail(l.number, "more than one #ip");
+            if (!program.instructions.empty()) fail(l.number, "#ip has to come before the instructions");
+            if (words.size() != 2 || !parse_number(words[1], ip_register) || !is_register(ip_register))
+            {
+                fail(l.number, "#ip needs a register number, from 0 to " + std::to_string(RegisterCount - 1));
+            }
+
+            program.ip_register = static_cast<size_t>(ip_register);
+            seen_ip = true;
+            continue;
+        }
+
+        // where the instruction goes, and where its op and operands start
+        long address = static_cast<long>(program.instructions.size());
+        size_t first = 0;
+        if (labelled)
+        {
+            if (!parse_label(words[0], address)) continue;     // just a note
+            first = 1;
+        }
+
+        Op op;
+        if (words.size() < first + 4) fail(l.number, "expected an op and three operands");
+        if (!labelled && words.size() > 4) fail(l.number, "unexpected '" + std::string(words[4]) + "' after the operands");
+        if (!parse_op(words[first], op)) fail(l.number, "unknown op '" + std::string(words[first]) + "'");
+
+        long operands[3];
+        for (size_t i = 0; i < 3; ++i)
+        {
+            if (!parse_number(words[first + 1 + i], operands[i]) ||
+                operands[i] < std::numeric_limits<RegisterType>::min() ||
+                operands[i] > std::numeric_limits<RegisterType>::max())
+            {
+                fail(l.number, "bad operand '" + std::string(words[first + 1 + i]) + "'");
+            }
+        }
+
+        if (reads_register_a(op) && !is_register(operands[0])) fail(l.number, "no register " + std::to_string(operands[0]));
+        if (reads_register_b(op) && !is_register(operands[1])) fail(l.number, "no register " + std::to_string(operands[1]));
+        if (!is_register(operands[2])) fail(l.number, "no register " + std::to_string(operands[2]));
+
+        if (!seen_ip) fail(l.number, "missing #ip before the first instruction");
+
+        // put it at its address
+        const size_t a = static_cast<size_t>(address);
+        if (a >= program.instructions.size())
+        {
+            program.instructions.resize(a + 1);
+            have_address.resize(a + 1, false);
+        }
+        if (have_address[a]) fail(l.number, "address A" + std::to_string(a) + " is given twice");
+
+        program.instructions[a] = {op,
+                                   static_cast<RegisterType>(operands[0]),
+                                   static_cast<RegisterType>(operands[1]),
+                                   static_cast<RegisterType>(operands[2])};
+        have_address[a] = true;
+    }
+
+    if (program.instructions.empty()) throw std::runtime_error("ElfCode program has no instructions");
+
+    auto missing = std::find(have_address.begin(), have_address.end(), false);
+    if (missing != have_address.end())
+    {
+        throw std::runtime_error("ElfCode program has no instruction at A" + std::to_string(missing - have_address.begin()));
+    }
+
+    return program;
 }
 
 
@@ -0,0 +1,163 @@
+#include "batch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+#include <unistd.h>
+
+#include "input_cache.h"
+#include "solver.h"
+
+#include "tbb/parallel_for.h"
+#include "tbb/task_arena.h"
+
+namespace fs = std::filesystem;
+
+
+std::string link_input_file(const std::string& filename, const std::string& scratch)
+{
+    const std::string canonical = fs::canonical(filename).string();
+
+    fs::path dir = fs::path(scratch) / ("input-" + std::to_string(hash_bytes(canonical)));
+    fs::create_directories(dir);
+
+    fs::path link = dir / "input.txt";
+    if (!fs::exists(fs::symlink_status(link))) fs::create_symlink(canonical, link);
+
+    return dir.string();
+}
+
+
+std::vector<BatchInput> collect_batch_inputs(const std::vector<std::string>& paths, const std::string& scratch)
+{
+    std::vector<BatchInput> inputs;
+    for (const auto& path : paths)
+    {
+        try
+        {
+            if (fs::is_regular_file(path))
+            {
+                inputs.push_back({path, link_input_file(path, scratch), {}});
+            }
+            else if (fs::is_regular_file(fs::path(path) / "input.txt"))
+            {
+                inputs.push_back({path, path, {}});
+            }
+            else if (fs::is_directory(path))
+            {
+                // a directory of inputs, in order so that the output is the same from run to run
+                std::vector<std::string> found;
+                for (const auto& entry : fs::directory_iterator(path))
+                {
+                    if (fs::is_regular_file(entry.path() / "input.txt")) found.push_back(entry.path().string());
+                }
+                if (found.empty()) throw std::runtime_error("No inputs in " + path);
+
+                std::sort(found.begin(), found.end());
+                for (const auto& dir : found) inputs.push_back({dir, dir, {}});
+            }
+            else
+            {
+                throw std::runtime_error("No such input: " + path);
+            }
+        }
+        catch (const std::exception& e)
+        {
+            inputs.push_back({path, {}, e.what()});
+        }
+    }
+    return inputs;
+}
+
+
+namespace
+{
+    // answers have to stay on their line
+    std::string escape_newlines(const std::string& s)
+    {
+        std::string escaped;
+        for (char c : s)
+        {
+            if (c == '\n') escaped += "\\n";
+            else escaped += c;
+        }
+        return escaped;
+    }
+}
+
+
+int run_batch(const std::string& name, std::unique_ptr<Solver> (*make_solver)(), const std::vector<std::string>& paths,
+              bool streamed)
+{
+    typedef std::chrono::steady_clock clock;
+
+    // (the scratch directory is only made if there are input files to link)
+    const fs::path scratch = fs::temp_directory_path() / (name + "-batch-" + std::to_string(::getpid()));
+
+    if (!make_solver()->reads_input())
+    {
+        std::cerr << name << ": The puzzle input is built in, so it can't solve other inputs" << std::endl;
+        return 1;
+    }
+
+    const std::vector<BatchInput> inputs = collect_batch_inputs(paths, scratch.string());
+
+    std::mutex output_mutex;
+    size_t failures = 0;
+
+    const auto start = clock::now();
+    tbb::parallel_for(size_t(0), inputs.size(), [&](size_t i)
+    {
+        const BatchInput& input = inputs[i];
+
+        std::ostringstream line;
+        line << input.path << "\t";
+
+        const auto input_start = clock::now();
+        bool failed = false;
+        try
+        {
+            if (!input.error.empty()) throw std::runtime_error(input.error);
+
+            tbb::this_task_arena::isolate([&]
+            {
+                auto solver = make_solver();
+                if (streamed) solver->parse_streamed(input.dir);
+                else solver->parse(input.dir);
+                line << escape_newlines(solver->part1()) << "\t";
+                line << escape_newlines(solver->part2()) << "\t";
+            });
+
+            const double ms = std::chrono::duration<double, std::milli>(clock::now() - input_start).count();
+            line << std::fixed << std::setprecision(1) << ms;
+        }
+        catch (const std::exception& e)
+        {
+            line.str("");
+            line << input.path << "\terror: " << escape_newlines(e.what());
+            failed = true;
+        }
+
+        // write each line as soon as it's ready
+        std::lock_guard<std::mutex> lock(output_mutex);
+        std::cout << line.str() << std::endl;
+        if (failed) ++failures;
+    });
+
+    const double seconds = std::chrono::duration<double>(clock::now() - start).count();
+    fs::remove_all(scratch);
+
+    std::cerr << name << ": " << inputs.size() << " inputs in " << std::fixed << std::setprecision(1) << seconds * 1000
+              << "ms";
+    if (failures > 0) std::cerr << ", " << failures << " failed";
+    std::cerr << std::endl;
+
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,57 @@
+//
+// Created by wuggy on 17/10/26.
+//
+
+#ifndef AOC2018_BATCH_H
+#define AOC2018_BATCH_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class Solver;
+
+// Batch mode: solving lots of inputs for one day in the one process, all at once.
+//
+//     day06 inputs/a inputs/b some/file.txt
+//     day06 inputs/
+//
+// Each input is a directory with the day's input files in it (as written by gen), or a directory of such
+// directories, or just an input file. They're solved in parallel (one Solver each), and a line is written to
+// stdout for each as soon as it's done:
+//
+//     <input>\t<part 1>\t<part 2>\t<milliseconds>
+//     <input>\terror: <what went wrong>
+//
+// An input that can't be found or solved doesn't stop the rest, but the exit status is non-zero at the end.
+// with any newlines in the answers (day 10's) written as \n.
+// The days with their puzzle input built in (see Solver::reads_input) can't be run like this.
+//
+// The days that use TBB themselves (day06, day11...) share the one scheduler with the batch, rather than
+// starting more threads of their own, and each input is solved in isolation - a thread waiting for its own
+// input's parallel loop only helps with that loop, rather than starting on another input part way through.
+
+
+struct BatchInput
+{
+    std::string path;   // as it was given (or found), for the output
+    std::string dir;    // where to parse it from
+    std::string error;  // why there's nothing to parse (a path that doesn't exist, say), if there isn't
+};
+
+// the inputs given on the command line (expanding directories of them, and linking plain input files into
+// directories of their own under 'scratch' as input.txt)
+// a path that doesn't lead to any inputs is kept, with an error, so it gets its own line in the output
+std::vector<BatchInput> collect_batch_inputs(const std::vector<std::string>& paths, const std::string& scratch);
+
+// a directory to parse for a plain input file, which has to be called input.txt for the days to find it:
+// a new directory under 'scratch' with an input.txt link to the file
+std::string link_input_file(const std::string& filename, const std::string& scratch);
+
+// solve all the inputs at these paths, writing a line for each, and returning non-zero if any failed
+// (streamed says to read each input as it's solved, see Solver::parse_streamed)
+int run_batch(const std::string& name, std::unique_ptr<Solver> (*make_solver)(), const std::vector<std::string>& paths,
+              bool streamed = false);
+
+
+#endif //AOC2018_BATCH_H
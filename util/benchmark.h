@@ -0,0 +1,268 @@
+//
+// Created by wuggy on 17/10/26.
+//
+
+#ifndef AOC2018_BENCHMARK_H
+#define AOC2018_BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "alloc_tracker.h"
+
+// A little benchmark harness, so the days can be timed without any extra libraries.
+//
+// Each day's main wraps its phases (parsing, part 1, part 2) in a BenchmarkSuite:
+//
+//     BenchmarkSuite bench("day02", argc, argv);
+//     auto lines = bench.phase("parse", [&] { return parse_lines(read_file("input.txt")); });
+//     std::cout << bench.phase("part1", [&] { return day02_solve_part1(lines); }) << std::endl;
+//     ...
+//     return bench.report();
+//
+// Normally each phase is just run once. With --bench on the command line each phase is also timed: it's
+// warmed up, then run in samples until the median settles (or the time runs out), and a table of the median,
+// 95th percentile and iterations per second is written to stderr (so stdout still has only the answers).
+// Next to the timings are the heap allocations of the phase's final run - how many, how many bytes, and the
+// high-water mark (see alloc_tracker.h; only allocations on the main thread are counted).
+
+
+// stop the compiler from optimising away a value, or the work that made it
+template<typename T>
+inline void do_not_optimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// stop the compiler from assuming memory hasn't changed (or keeping values in registers) across this point
+inline void clobber_memory()
+{
+    asm volatile("" : : : "memory");
+}
+
+
+struct BenchmarkOptions
+{
+    double warmup_seconds = 0.1;
+    double min_sample_seconds = 0.001;  // quick phases are run in batches that take at least this long
+    double max_seconds = 2.0;           // give up waiting for the median to settle after this long...
+    size_t min_samples = 3;             // ...but always take at least this many samples
+    size_t max_samples = 1000;
+    double stable_fraction = 0.01;      // settled if the median moves by less than this between checks
+};
+
+
+struct BenchmarkResult
+{
+    std::string name;
+    size_t iterations = 0;      // total calls timed (not counting the warmup)
+    size_t samples = 0;
+    double median_seconds = 0;  // per call
+    double p95_seconds = 0;
+    double min_seconds = 0;
+
+    AllocStats allocs;          // from a single call
+
+    double per_second() const
+    {
+        return median_seconds > 0 ? 1.0 / median_seconds : 0;
+    }
+};
+
+
+namespace benchmark_detail
+{
+    typedef std::chrono::steady_clock clock;
+
+    inline double seconds_since(clock::time_point start)
+    {
+        return std::chrono::duration<double>(clock::now() - start).count();
+    }
+
+    // the value at fraction q of the way through some sorted samples
+    inline double percentile(const std::vector<double>& sorted, double q)
+    {
+        size_t i = static_cast<size_t>(q * (sorted.size() - 1) + 0.5);
+        return sorted[std::min(i, sorted.size() - 1)];
+    }
+
+    inline double median(std::vector<double> samples)
+    {
+        std::sort(samples.begin(), samples.end());
+        return percentile(samples, 0.5);
+    }
+
+    inline std::string format_seconds(double s)
+    {
+        std::ostringstream os;
+        os << std::fixed << std::setprecision(2);
+        if (s < 1e-6) os << s * 1e9 << "ns";
+        else if (s < 1e-3) os << s * 1e6 << "us";
+        else if (s < 1) os << s * 1e3 << "ms";
+        else os << s << "s";
+        return os.str();
+    }
+
+    inline std::string format_bytes(double b)
+    {
+        std::ostringstream os;
+        os << std::fixed << std::setprecision(1);
+        if (b < 1024) os << b << "B";
+        else if (b < 1024 * 1024) os << b / 1024 << "KB";
+        else if (b < 1024 * 1024 * 1024) os << b / (1024 * 1024) << "MB";
+        else os << b / (1024 * 1024 * 1024) << "GB";
+        return os.str();
+    }
+}
+
+
+// time f (which takes no arguments) until its per-call time is stable
+template<typename F>
+BenchmarkResult run_benchmark(const std::string& name, F&& f, const BenchmarkOptions& options = BenchmarkOptions())
+{
+    using namespace benchmark_detail;
+
+    auto call = [&f]()
+    {
+        if constexpr (std::is_void<decltype(f())>::value) f();
+        else do_not_optimize(f());
+        clobber_memory();
+    };
+
+    // warm up (caches, allocators, lazily built tables...) and get a rough idea of the time per call
+    size_t warmup_calls = 0;
+    auto warmup_start = clock::now();
+    do
+    {
+        call();
+        ++warmup_calls;
+    } while (seconds_since(warmup_start) < options.warmup_seconds);
+    const double rough_call_seconds = seconds_since(warmup_start) / warmup_calls;
+
+    const size_t batch = std::max<size_t>(1, static_cast<size_t>(options.min_sample_seconds / rough_call_seconds));
+
+    std::vector<double> samples;
+    double last_median = 0;
+    auto start = clock::now();
+    while (samples.size() < options.max_samples)
+    {
+        auto sample_start = clock::now();
+        for (size_t i = 0; i < batch; ++i) call();
+        samples.push_back(seconds_since(sample_start) / batch);
+
+        if (samples.size() < options.min_samples) continue;
+        if (seconds_since(start) > options.max_seconds) break;
+
+        // every so often, see if the median has settled
+        if (samples.size() % options.min_samples == 0)
+        {
+            double m = median(samples);
+            if (last_median > 0 && std::abs(m - last_median) <= options.stable_fraction * m) break;
+            last_median = m;
+        }
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    BenchmarkResult r;
+    r.name = name;
+    r.samples = samples.size();
+    r.iterations = samples.size() * batch;
+    r.median_seconds = percentile(samples, 0.5);
+    r.p95_seconds = percentile(samples, 0.95);
+    r.min_seconds = samples.front();
+    return r;
+}
+
+
+inline void print_benchmark_results(std::ostream& os, const std::string& title, const std::vector<BenchmarkResult>& results)
+{
+    using namespace benchmark_detail;
+
+    os << title << std::endl;
+    os << "  " << std::left << std::setw(14) << "phase" << std::right
+       << std::setw(12) << "median" << std::setw(12) << "p95" << std::setw(12) << "min"
+       << std::setw(12) << "iters" << std::setw(14) << "iters/s"
+       << std::setw(12) << "allocs" << std::setw(12) << "bytes" << std::setw(12) << "peak" << std::endl;
+
+    for (const auto& r : results)
+    {
+        os << "  " << std::left << std::setw(14) << r.name << std::right
+           << std::setw(12) << format_seconds(r.median_seconds)
+           << std::setw(12) << format_seconds(r.p95_seconds)
+           << std::setw(12) << format_seconds(r.min_seconds)
+           << std::setw(12) << r.iterations
+           << std::setw(14) << std::fixed << std::setprecision(1) << r.per_second()
+           << std::setw(12) << r.allocs.allocations
+           << std::setw(12) << format_bytes(r.allocs.bytes)
+           << std::setw(12) << format_bytes(r.allocs.peak_bytes) << std::endl;
+    }
+}
+
+
+// the phases of one day, timed if --bench was given
+class BenchmarkSuite
+{
+private:
+    std::string title;
+    bool enabled = false;
+    BenchmarkOptions options;
+    std::vector<BenchmarkResult> results;
+
+public:
+    BenchmarkSuite(std::string name, int argc, char* argv[]) : title(std::move(name))
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], "--bench") == 0) enabled = true;
+        }
+    }
+
+    bool benchmarking() const
+    {
+        return enabled;
+    }
+
+    // run a phase and return its result (timing it first, and counting the allocations of the run whose
+    // result is returned, if benchmarking)
+    template<typename F>
+    auto phase(const std::string& name, F&& f) -> decltype(f())
+    {
+        if (!enabled) return f();
+
+        results.push_back(run_benchmark(name, f, options));
+
+        AllocRegion region;
+        if constexpr (std::is_void<decltype(f())>::value)
+        {
+            f();
+            results.back().allocs = region.stats();
+        }
+        else
+        {
+            auto result = f();
+            results.back().allocs = region.stats();
+            return result;
+        }
+    }
+
+    // print the timings (if any), and give main something to return
+    int report() const
+    {
+        if (enabled) print_benchmark_results(std::cerr, title, results);
+        return 0;
+    }
+};
+
+
+#endif //AOC2018_BENCHMARK_H
@@ -0,0 +1,157 @@
+//
+// Created by wuggy on 17/10/26.
+//
+
+#ifndef AOC2018_CYCLE_H
+#define AOC2018_CYCLE_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+// Cycle detection for simulations that are run for far more generations than can be stepped through, but
+// which settle into a loop: x0, x1, ... x(mu-1) lead in, then x(mu) .. x(mu+lambda-1) repeat forever.
+//
+// The step function can either return the next state (State step(const State&)) or write it into a second
+// state (void step(const State& from, State& to)), which saves reallocating big states every generation.
+//
+// Brent's algorithm only ever keeps two states around, so it needs no history however long the lead-in or
+// the loop. States are compared by a 64-bit fingerprint from the hasher first, and only if the fingerprints
+// match are they compared in full with the equality (pass verify = false to trust the fingerprints alone).
+// The hasher and equality can be any notion of "the same state" - e.g. the same shape, ignoring position.
+
+
+struct Cycle
+{
+    uint64_t mu = 0;        // the first generation of the loop
+    uint64_t lambda = 0;    // the length of the loop
+
+    // the earliest generation with the same state as generation n
+    uint64_t equivalent_generation(uint64_t n) const
+    {
+        assert(lambda > 0);
+        if (n < mu) return n;
+        return mu + (n - mu) % lambda;
+    }
+
+    // how many whole loops have gone by to get to generation n
+    uint64_t loops_before(uint64_t n) const
+    {
+        assert(lambda > 0);
+        if (n < mu) return 0;
+        return (n - mu) / lambda;
+    }
+};
+
+
+namespace cycle_detail
+{
+    template<typename State, typename Step>
+    void step_into(Step& step, const State& from, State& to)
+    {
+        if constexpr (std::is_invocable<Step&, const State&, State&>::value) step(from, to);
+        else to = step(from);
+    }
+
+    // a state with its fingerprint, advanced with a spare so in-place steps can double-buffer
+    template<typename State, typename Step, typename Hasher>
+    struct Cursor
+    {
+        State state;
+        State spare;
+        uint64_t fingerprint = 0;
+
+        Cursor(const State& s, Hasher& hasher) : state(s), spare(s), fingerprint(hasher(s)) {}
+
+        void advance(Step& step, Hasher& hasher)
+        {
+            step_into(step, state, spare);
+            std::swap(state, spare);
+            fingerprint = hasher(state);
+        }
+    };
+}
+
+
+// advance a state by n generations
+template<typename State, typename Step>
+State advance(const State& initial, Step&& step, uint64_t n)
+{
+    State s = initial;
+    State spare = initial;
+    for (uint64_t i = 0; i < n; ++i)
+    {
+        cycle_detail::step_into(step, s, spare);
+        std::swap(s, spare);
+    }
+    return s;
+}
+
+
+// find the lead-in (mu) and loop length (lambda) of the states generated from initial
+// (this never returns if the states never repeat!)
+template<typename State, typename Step, typename Hasher = std::hash<State>, typename Equal = std::equal_to<State>>
+Cycle find_cycle(const State& initial, Step&& step, Hasher hasher = Hasher(), Equal equal = Equal(), bool verify = true)
+{
+    typedef cycle_detail::Cursor<State, std::remove_reference_t<Step>, Hasher> Cursor;
+
+    auto same = [&](const Cursor& a, const Cursor& b) -> bool
+    {
+        return a.fingerprint == b.fingerprint && (!verify || equal(a.state, b.state));
+    };
+
+    // find lambda: the tortoise waits at successive powers of two while the hare runs on, until they meet
+    Cycle c;
+    {
+        Cursor tortoise(initial, hasher);
+        Cursor hare(initial, hasher);
+        hare.advance(step, hasher);
+
+        uint64_t power = 1;
+        c.lambda = 1;
+        while (!same(tortoise, hare))
+        {
+            if (power == c.lambda)
+            {
+                tortoise.state = hare.state;
+                tortoise.fingerprint = hare.fingerprint;
+                power *= 2;
+                c.lambda = 0;
+            }
+
+            hare.advance(step, hasher);
+            ++c.lambda;
+        }
+    }
+
+    // find mu: with the hare lambda ahead, run both from the start until they meet at the start of the loop
+    {
+        Cursor tortoise(initial, hasher);
+        Cursor hare(initial, hasher);
+        for (uint64_t i = 0; i < c.lambda; ++i) hare.advance(step, hasher);
+
+        c.mu = 0;
+        while (!same(tortoise, hare))
+        {
+            tortoise.advance(step, hasher);
+            hare.advance(step, hasher);
+            ++c.mu;
+        }
+    }
+
+    return c;
+}
+
+
+// the state at generation n (however big), by skipping the whole loops
+template<typename State, typename Step>
+State state_at(const State& initial, Step&& step, const Cycle& c, uint64_t n)
+{
+    return advance(initial, step, c.equivalent_generation(n));
+}
+
+
+#endif //AOC2018_CYCLE_H
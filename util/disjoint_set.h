@@ -0,0 +1,179 @@
+//
+// Created by wuggy on 17/10/26.
+//
+
+#ifndef AOC2018_DISJOINT_SET_H
+#define AOC2018_DISJOINT_SET_H
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "hash.h"
+
+// Union-find over the items 0..n-1, for grouping things into connected components.
+// Each set is a tree whose root is the set's representative; find() compresses the path it walks so the
+// trees stay flat, and unite() hangs the shallower tree under the deeper one (union by rank).
+class DisjointSet
+{
+private:
+    std::vector<size_t> parent;
+    std::vector<uint8_t> rank;
+    std::vector<size_t> sizes;      // only meaningful at the roots
+    size_t n_sets = 0;
+
+public:
+    explicit DisjointSet(size_t n = 0) : parent(n), rank(n, 0), sizes(n, 1), n_sets(n)
+    {
+        std::iota(parent.begin(), parent.end(), 0);
+    }
+
+    size_t find(size_t x)
+    {
+        assert(x < parent.size());
+
+        size_t root = x;
+        while (parent[root] != root) root = parent[root];
+
+        // point everything on the way at the root
+        while (parent[x] != root) x = std::exchange(parent[x], root);
+
+        return root;
+    }
+
+    // join the sets of a and b, returning false if they were already the same set
+    bool unite(size_t a, size_t b)
+    {
+        a = find(a);
+        b = find(b);
+        if (a == b) return false;
+
+        if (rank[a] < rank[b]) std::swap(a, b);
+        parent[b] = a;
+        sizes[a] += sizes[b];
+        if (rank[a] == rank[b]) ++rank[a];
+
+        --n_sets;
+        return true;
+    }
+
+    bool same(size_t a, size_t b)
+    {
+        return find(a) == find(b);
+    }
+
+    // how many items are in x's set
+    size_t set_size(size_t x)
+    {
+        return sizes[find(x)];
+    }
+
+    size_t set_count() const
+    {
+        return n_sets;
+    }
+
+    size_t size() const
+    {
+        return parent.size();
+    }
+};
+
+
+// A union-find that can be used from many threads at once (e.g. inside tbb::parallel_for) without locks.
+// Roots are linked with a compare-and-swap on the parent, and a link only succeeds if the child is still
+// a root, so racing unions just retry (after Anderson & Woll's concurrent union-find). Instead of ranks,
+// which can't be updated atomically with the parent, the root with the lower (hashed, so effectively
+// random) priority is always linked under the other: that keeps the trees shallow in expectation and can
+// never make a cycle. find() halves the path as it goes, and lost races there are harmless.
+class ConcurrentDisjointSet
+{
+private:
+    std::unique_ptr<std::atomic<size_t>[]> parent;
+    size_t n = 0;
+    std::atomic<size_t> n_sets{0};
+
+    static bool links_under(size_t a, size_t b)
+    {
+        // should root a be linked under root b?
+        uint64_t pa = hash_mix(a);
+        uint64_t pb = hash_mix(b);
+        return pa < pb || (pa == pb && a < b);
+    }
+
+public:
+    explicit ConcurrentDisjointSet(size_t count = 0) : parent(new std::atomic<size_t>[count]), n(count), n_sets(count)
+    {
+        for (size_t i = 0; i < n; ++i) parent[i].store(i, std::memory_order_relaxed);
+    }
+
+    size_t find(size_t x) const
+    {
+        assert(x < n);
+
+        while (true)
+        {
+            size_t p = parent[x].load(std::memory_order_acquire);
+            if (p == x) return x;
+
+            size_t gp = parent[p].load(std::memory_order_acquire);
+            if (gp == p) return p;
+
+            // path halving: skip x past its parent (if someone else got there first, that's fine too)
+            parent[x].compare_exchange_weak(p, gp, std::memory_order_release, std::memory_order_relaxed);
+            x = gp;
+        }
+    }
+
+    bool unite(size_t a, size_t b)
+    {
+        while (true)
+        {
+            a = find(a);
+            b = find(b);
+            if (a == b) return false;
+
+            if (!links_under(a, b)) std::swap(a, b);
+
+            // link a under b, but only if a is still a root - otherwise go around again
+            size_t expected = a;
+            if (parent[a].compare_exchange_strong(expected, b, std::memory_order_acq_rel, std::memory_order_relaxed))
+            {
+                n_sets.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+
+    // if unions are running at the same time, this is the answer at some moment during the call
+    bool same(size_t a, size_t b) const
+    {
+        while (true)
+        {
+            a = find(a);
+            b = find(b);
+            if (a == b) return true;
+
+            // a is still a root, so they really are different sets (right now)
+            if (parent[a].load(std::memory_order_acquire) == a) return false;
+        }
+    }
+
+    size_t set_count() const
+    {
+        return n_sets.load(std::memory_order_relaxed);
+    }
+
+    size_t size() const
+    {
+        return n;
+    }
+};
+
+
+#endif //AOC2018_DISJOINT_SET_H
@@ -0,0 +1,176 @@
+//
+// Created by wuggy on 17/10/26.
+//
+
+#ifndef AOC2018_FIELD_SCANNER_H
+#define AOC2018_FIELD_SCANNER_H
+
+#include <cctype>
+#include <charconv>
+#include <string_view>
+#include <type_traits>
+
+// A cursor over a line of text, for pulling literals, integers and tokens out of it without allocating.
+// Like an istream, every field skips any leading whitespace, and the first failure sticks: everything after it
+// is a no-op, and error_position() says where parsing went wrong.
+class FieldScanner
+{
+private:
+    std::string_view text;
+    size_t pos = 0;
+    size_t error_pos = std::string_view::npos;
+
+    bool fail()
+    {
+        if (error_pos == std::string_view::npos) error_pos = pos;
+        return false;
+    }
+
+public:
+    explicit FieldScanner(std::string_view t) : text(t) {}
+
+    bool ok() const
+    {
+        return error_pos == std::string_view::npos;
+    }
+
+    explicit operator bool() const
+    {
+        return ok();
+    }
+
+    size_t position() const
+    {
+        return pos;
+    }
+
+    size_t error_position() const  // npos if there was no error
+    {
+        return error_pos;
+    }
+
+    std::string_view remaining() const
+    {
+        return text.substr(pos);
+    }
+
+    void skip_whitespace()
+    {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+    }
+
+    // match a run of characters exactly where the cursor is, without skipping any whitespace
+    bool exact(std::string_view lit)
+    {
+        if (!ok()) return false;
+        if (text.compare(pos, lit.size(), lit) != 0) return fail();
+
+        pos += lit.size();
+        return true;
+    }
+
+    // match a single, exact character
+    bool literal(char c)
+    {
+        if (!ok()) return false;
+
+        skip_whitespace();
+        if (pos >= text.size() || text[pos] != c) return fail();
+
+        ++pos;
+        return true;
+    }
+
+    // match a sequence of characters (each of which may be preceded by whitespace, like the istream matchers were)
+    bool literal(std::string_view lit)
+    {
+        for (char c : lit)
+        {
+            if (!literal(c)) return false;
+        }
+        return ok();
+    }
+
+    // read any single non-whitespace character
+    bool character(char& c)
+    {
+        if (!ok()) return false;
+
+        skip_whitespace();
+        if (pos >= text.size()) return fail();
+
+        c = text[pos++];
+        return true;
+    }
+
+    // read a run of non-whitespace characters, as a view into the text
+    bool token(std::string_view& t)
+    {
+        if (!ok()) return false;
+
+        skip_whitespace();
+        size_t start = pos;
+        while (pos < text.size() && !std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+
+        if (pos == start) return fail();
+
+        t = text.substr(start, pos - start);
+        return true;
+    }
+
+    // read a signed or unsigned integer, allowing an explicit '+' as an istream would
+    template<typename Int>
+    bool integer(Int& v)
+    {
+        static_assert(std::is_integral<Int>::value, "integer() needs an integral type");
+
+        if (!ok()) return false;
+
+        skip_whitespace();
+        if (pos < text.size() && text[pos] == '+') ++pos;
+
+        const char* first = text.data() + pos;
+        const char* last = text.data() + text.size();
+
+        auto result = std::from_chars(first, last, v);
+        if (result.ec != std::errc()) return fail();
+
+        pos += result.ptr - first;
+        return true;
+    }
+};
+
+
+inline FieldScanner& operator>>(FieldScanner& s, const char& cliteral)
+{
+    s.literal(cliteral);
+    return s;
+}
+
+inline FieldScanner& operator>>(FieldScanner& s, const char* cliteralp)
+{
+    s.literal(std::string_view(cliteralp));
+    return s;
+}
+
+inline FieldScanner& operator>>(FieldScanner& s, char& c)
+{
+    s.character(c);
+    return s;
+}
+
+inline FieldScanner& operator>>(FieldScanner& s, std::string_view& t)
+{
+    s.token(t);
+    return s;
+}
+
+template<typename Int, typename = std::enable_if_t<std::is_integral<Int>::value && !std::is_same<Int, char>::value>>
+FieldScanner& operator>>(FieldScanner& s, Int& v)
+{
+    s.integer(v);
+    return s;
+}
+
+
+#endif //AOC2018_FIELD_SCANNER_H
@@ -1,32 +1,171 @@
 #include "file_parsing.h"
 
-#include <fstream>
-#include <sstream>
-#include <cassert>
+#include <cstdint>
 #include <regex>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+
+MappedFile::MappedFile(const std::string& filename)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Failed to open " + filename);
+
+    struct stat st = {};
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        // an empty file can't be mapped, so it's left as an empty view
+        void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            close(fd);
+            throw std::runtime_error("Failed to map " + filename);
+        }
+
+        // we're going to read it front to back, so let the kernel read ahead
+        madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+
+        data = static_cast<const char*>(p);
+        length = static_cast<size_t>(st.st_size);
+    }
+
+    // the mapping keeps the file alive, we don't need the descriptor any more
+    close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data) munmap(const_cast<char*>(data), length);
+}
+
+MappedFile::MappedFile(MappedFile&& o) noexcept : data(o.data), length(o.length)
+{
+    o.data = nullptr;
+    o.length = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& o) noexcept
+{
+    std::swap(data, o.data);
+    std::swap(length, o.length);
+    return *this;
+}
+
 
 // read a whole file into a plain string, newlines and all
 std::string read_file(const std::string& filename)
 {
-    std::ifstream fs(filename);
-    assert(fs);
+    // copy straight out of the mapping, rather than through a stream and a stringstream
+    MappedFile mf(filename);
+    return std::string(mf.text());
+}
+
+namespace
+{
+    using FindDelimitersFunc = void (*)(std::string_view, char, std::vector<size_t>&);
+
+    void find_delimiters_scalar(std::string_view s, size_t begin, char delim, std::vector<size_t>& offsets)
+    {
+        for (size_t i = begin; i < s.size(); ++i)
+        {
+            if (s[i] == delim) offsets.push_back(i);
+        }
+    }
 
-    std::stringstream ss;
-    ss << fs.rdbuf();
+#if defined(__x86_64__)
+    void find_delimiters_sse2(std::string_view s, char delim, std::vector<size_t>& offsets)
+    {
+        // compare 16 characters at a time, then walk the set bits of the match mask
+        const __m128i d = _mm_set1_epi8(delim);
 
-    return ss.str();
+        size_t i = 0;
+        for (; i + 16 <= s.size(); i += 16)
+        {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s.data() + i));
+            auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, d)));
+
+            for (; mask; mask &= mask - 1) offsets.push_back(i + __builtin_ctz(mask));
+        }
+
+        find_delimiters_scalar(s, i, delim, offsets);   // the leftover tail
+    }
+
+    __attribute__((target("avx2")))
+    void find_delimiters_avx2(std::string_view s, char delim, std::vector<size_t>& offsets)
+    {
+        // as for sse2, but 32 characters at a time
+        const __m256i d = _mm256_set1_epi8(delim);
+
+        size_t i = 0;
+        for (; i + 32 <= s.size(); i += 32)
+        {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s.data() + i));
+            auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, d)));
+
+            for (; mask; mask &= mask - 1) offsets.push_back(i + __builtin_ctz(mask));
+        }
+
+        find_delimiters_scalar(s, i, delim, offsets);   // the leftover tail
+    }
+#else
+    void find_delimiters_scalar(std::string_view s, char delim, std::vector<size_t>& offsets)
+    {
+        find_delimiters_scalar(s, 0, delim, offsets);
+    }
+#endif
+
+    FindDelimitersFunc select_find_delimiters()
+    {
+#if defined(__x86_64__)
+        if (__builtin_cpu_supports("avx2")) return find_delimiters_avx2;
+        return find_delimiters_sse2;    // every x86-64 has sse2
+#else
+        return find_delimiters_scalar;
+#endif
+    }
+
+    template<typename Field>
+    std::vector<Field> split_at_delimiters(std::string_view input, char delim)
+    {
+        // empty fields are kept, except for an empty field after a trailing delimiter
+        // (the same rules as splitting with std::getline)
+        std::vector<size_t> offsets;
+        find_delimiters(input, delim, offsets);
+
+        std::vector<Field> split;
+        split.reserve(offsets.size() + 1);
+
+        size_t start = 0;
+        for (size_t end : offsets)
+        {
+            split.emplace_back(input.substr(start, end - start));
+            start = end + 1;
+        }
+        if (start < input.size()) split.emplace_back(input.substr(start));
+
+        return split;
+    }
 }
 
-std::vector<std::string> split_string(const std::string& input, char delim)
-{
-    // see: https://stackoverflow.com/a/27511119
 
-    std::stringstream ss(input);
-    std::vector<std::string> split;
-    std::string item;
-    while(std::getline(ss, item, delim)) split.push_back(std::move(item));
+void find_delimiters(std::string_view s, char delim, std::vector<size_t>& offsets)
+{
+    // pick the widest implementation the cpu supports, once
+    static const FindDelimitersFunc impl = select_find_delimiters();
+    impl(s, delim, offsets);
+}
 
-    return split;
+std::vector<std::string> split_string(const std::string& input, char delim)
+{
+    return split_at_delimiters<std::string>(input, delim);
 }
 
 // split a string into separate lines
@@ -34,3 +173,14 @@ std::vector<std::string> parse_lines(const std::string& s)
 {
     return split_string(s, '\n');
 }
+
+std::vector<std::string_view> split_string_view(std::string_view input, char delim)
+{
+    return split_at_delimiters<std::string_view>(input, delim);
+}
+
+// split some text into separate lines, as views into the original text
+std::vector<std::string_view> parse_lines_view(std::string_view s)
+{
+    return split_string_view(s, '\n');
+}
@@ -7,9 +7,45 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
 #include <functional>
 #include <iostream>
 
+// a read-only file mapped into memory, so it can be parsed without copying it
+// the text (and any views into it) are only valid while the MappedFile is alive
+// a file that can't be opened (or mapped) throws a std::runtime_error naming it
+class MappedFile
+{
+private:
+    const char* data = nullptr;
+    size_t length = 0;
+
+public:
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile(MappedFile&& o) noexcept;
+
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&& o) noexcept;
+
+    std::string_view text() const
+    {
+        return {data, length};
+    }
+
+    size_t size() const
+    {
+        return length;
+    }
+
+    bool empty() const
+    {
+        return length == 0;
+    }
+};
+
 // read a whole file into a plain string, newlines and all
 std::string read_file(const std::string& filename);
 
@@ -19,37 +55,25 @@ std::vector<std::string> parse_lines(const std::string& s);
 // split a string into separate fields with a given delimiter
 std::vector<std::string> split_string(const std::string& input, char delim);
 
-// convert a pile of strings into a pile of... something else...
-template<typename T>
-std::vector<T> convert_strings(const std::vector<std::string> &s, const std::function<T(const std::string &)> &c)
+// find the offset of every occurrence of delim in s, appending them to offsets
+// scans a block at a time with SSE2/AVX2 where the cpu has them
+void find_delimiters(std::string_view s, char delim, std::vector<size_t>& offsets);
+
+// split some text into separate lines, as views into the original text
+std::vector<std::string_view> parse_lines_view(std::string_view s);
+
+// split some text into separate fields with a given delimiter, as views into the original text
+std::vector<std::string_view> split_string_view(std::string_view input, char delim);
+
+// convert a pile of strings (or string_views) into a pile of... something else...
+template<typename T, typename Line, typename Converter>
+std::vector<T> convert_strings(const std::vector<Line> &s, Converter&& c)
 {
     std::vector<T> converted;
+    converted.reserve(s.size());
     for (const auto& l : s) converted.emplace_back(c(l));
     return converted;
 }
 
-template<class e, class t>
-std::basic_istream<e,t>& operator >>(std::basic_istream<e,t>& in, const e& cliteral)
-{
-    e buffer(0);
-    in >> buffer;
-    if (buffer != cliteral) in.setstate(std::ios::failbit);
-    return in;
-}
-
-template<class e, class t>
-std::basic_istream<e,t>& operator >>(std::basic_istream<e,t>& in, const e* cliteralp)
-{
-    while (*cliteralp)
-    {
-        e buffer(0);
-        in >> buffer;
-        if (buffer != *cliteralp) in.setstate(std::ios::failbit);
-
-        ++cliteralp;
-    }
-    return in;
-}
-
 
 #endif //AOC2018_FILE_PARSING_H
@@ -0,0 +1,489 @@
+//
+// Created by wuggy on 17/10/26.
+//
+
+#ifndef AOC2018_FLAT_HASH_H
+#define AOC2018_FLAT_HASH_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "hash.h"
+
+// Open-addressing hash sets and maps, laid out like a SwissTable:
+// the entries live in one flat array of slots, with a parallel array of one-byte control values which say
+// whether each slot is empty, deleted, or full (and if it's full, holds 7 bits of the entry's hash).
+// Lookups check the control bytes 16 at a time (with one SSE2 compare where we have it), and only look at
+// a slot when its 7 hash bits match, so a probe is usually one cache line of control bytes and one slot.
+//
+// Unlike the std containers, inserting can move every entry, so nothing (except end()) stays valid over
+// an insert. Keys and values must be default constructible, since every slot holds one.
+
+
+// std::hash is often the identity for integers, so mix whatever it gives us before using it
+template<typename T>
+struct FlatHash
+{
+    size_t operator()(const T& v) const noexcept
+    {
+        return hash_mix(std::hash<T>()(v));
+    }
+};
+
+
+namespace flat_hash_detail
+{
+    constexpr int8_t ctrl_empty = -128;     // 0b10000000
+    constexpr int8_t ctrl_deleted = -2;     // 0b11111110
+    // anything else (0..127) is a full slot, holding the low 7 bits of its hash
+
+    constexpr size_t group_size = 16;
+
+    inline bool is_full(int8_t c)
+    {
+        return c >= 0;
+    }
+
+#if defined(__SSE2__)
+    // bitmasks of which of the 16 control bytes in a group are interesting
+    inline uint32_t match_byte(const int8_t* group, int8_t h2)
+    {
+        __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(h2))));
+    }
+
+    inline uint32_t match_empty(const int8_t* group)
+    {
+        return match_byte(group, ctrl_empty);
+    }
+
+    inline uint32_t match_empty_or_deleted(const int8_t* group)
+    {
+        // empty and deleted are the only control values with the top bit set
+        __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<uint32_t>(_mm_movemask_epi8(g));
+    }
+#else
+    inline uint32_t match_byte(const int8_t* group, int8_t h2)
+    {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < group_size; ++i)
+        {
+            if (group[i] == h2) mask |= 1u << i;
+        }
+        return mask;
+    }
+
+    inline uint32_t match_empty(const int8_t* group)
+    {
+        return match_byte(group, ctrl_empty);
+    }
+
+    inline uint32_t match_empty_or_deleted(const int8_t* group)
+    {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < group_size; ++i)
+        {
+            if (!is_full(group[i])) mask |= 1u << i;
+        }
+        return mask;
+    }
+#endif
+
+
+    // the table itself, shared by the set and the map
+    // KeyOf gets the key out of a slot (the slot itself for a set, .first for a map)
+    template<typename Slot, typename Key, typename KeyOf, typename Hash, typename KeyEqual>
+    class FlatTable
+    {
+    public:
+        static constexpr size_t npos = ~size_t(0);
+
+    private:
+        std::vector<int8_t> ctrl;
+        std::vector<Slot> slots;
+        size_t n_full = 0;
+        size_t n_deleted = 0;
+
+        size_t group_mask() const
+        {
+            return slots.size() / group_size - 1;
+        }
+
+        // grow before more than 7/8ths of the slots are used (deleted slots still get in the way of a probe)
+        bool needs_growing() const
+        {
+            return (n_full + n_deleted + 1) * 8 > slots.size() * 7;
+        }
+
+        static size_t h1(size_t h) { return h >> 7; }
+        static int8_t h2(size_t h) { return static_cast<int8_t>(h & 0x7f); }
+
+        // visit the groups of the probe sequence for hash h until f returns true
+        // (triangular steps, which visit every group once since the group count is a power of 2)
+        template<typename F>
+        void probe(size_t h, F&& f) const
+        {
+            const size_t mask = group_mask();
+            size_t g = h1(h) & mask;
+            for (size_t step = 1; ; ++step)
+            {
+                if (f(g * group_size)) return;
+                g = (g + step) & mask;
+                assert(step <= mask + 1);   // the table can never be completely full
+            }
+        }
+
+        void rehash(size_t new_capacity)
+        {
+            std::vector<int8_t> old_ctrl = std::exchange(ctrl, std::vector<int8_t>(new_capacity, ctrl_empty));
+            std::vector<Slot> old_slots = std::exchange(slots, std::vector<Slot>(new_capacity));
+            n_full = 0;
+            n_deleted = 0;
+
+            for (size_t i = 0; i < old_slots.size(); ++i)
+            {
+                if (is_full(old_ctrl[i])) place(hash_of(KeyOf()(old_slots[i])), std::move(old_slots[i]));
+            }
+        }
+
+        size_t hash_of(const Key& k) const
+        {
+            return Hash()(k);
+        }
+
+        // put a slot we know isn't already in the table into the first free place on its probe sequence
+        size_t place(size_t h, Slot&& s)
+        {
+            size_t index = npos;
+            probe(h, [&](size_t group) {
+                uint32_t free = match_empty_or_deleted(&ctrl[group]);
+                if (!free) return false;
+
+                index = group + __builtin_ctz(free);
+                return true;
+            });
+
+            if (ctrl[index] == ctrl_deleted) --n_deleted;
+            ctrl[index] = h2(h);
+            slots[index] = std::move(s);
+            ++n_full;
+            return index;
+        }
+
+    public:
+        FlatTable() = default;
+
+        size_t find_index(const Key& k) const
+        {
+            if (slots.empty()) return npos;
+
+            const size_t h = hash_of(k);
+            size_t found = npos;
+            probe(h, [&](size_t group) {
+                const int8_t* g = &ctrl[group];
+                for (uint32_t m = match_byte(g, h2(h)); m; m &= m - 1)
+                {
+                    size_t i = group + __builtin_ctz(m);
+                    if (KeyEqual()(KeyOf()(slots[i]), k))
+                    {
+                        found = i;
+                        return true;
+                    }
+                }
+
+                // an empty slot in the group means the key would have gone here, so it's not in the table
+                return match_empty(g) != 0;
+            });
+
+            return found;
+        }
+
+        // the index of the slot for k, and whether it had to be inserted (with make_slot())
+        template<typename MakeSlot>
+        std::pair<size_t, bool> find_or_insert(const Key& k, MakeSlot&& make_slot)
+        {
+            size_t index = find_index(k);
+            if (index != npos) return {index, false};
+
+            if (needs_growing())
+            {
+                // if it's mostly tombstones, just clean up at the same size
+                size_t capacity = slots.empty() ? group_size : slots.size();
+                if (n_full * 2 >= capacity) capacity *= 2;
+                rehash(capacity);
+            }
+
+            return {place(hash_of(k), make_slot()), true};
+        }
+
+        bool erase_index(size_t index)
+        {
+            if (index == npos) return false;
+
+            ctrl[index] = ctrl_deleted;
+            slots[index] = Slot();
+            --n_full;
+            ++n_deleted;
+            return true;
+        }
+
+        void reserve(size_t n)
+        {
+            size_t capacity = group_size;
+            while (capacity * 7 < n * 8) capacity *= 2;
+            if (capacity > slots.size()) rehash(capacity);
+        }
+
+        void clear()
+        {
+            ctrl.clear();
+            slots.clear();
+            n_full = 0;
+            n_deleted = 0;
+        }
+
+        // the first full slot at or after i, or npos
+        size_t next_full(size_t i) const
+        {
+            for (; i < ctrl.size(); ++i)
+            {
+                if (is_full(ctrl[i])) return i;
+            }
+            return npos;
+        }
+
+        Slot& slot(size_t i) { return slots[i]; }
+        const Slot& slot(size_t i) const { return slots[i]; }
+
+        size_t size() const { return n_full; }
+        size_t capacity() const { return slots.size(); }
+    };
+
+
+    // iterates the full slots of a table in slot order
+    template<typename Table, typename Value>
+    class FlatIterator
+    {
+    private:
+        Table* table = nullptr;
+        size_t index = Table::npos;
+
+    public:
+        FlatIterator() = default;
+        FlatIterator(Table* t, size_t i) : table(t), index(i) {}
+
+        // a non-const iterator converts to a const one
+        template<typename OtherTable, typename OtherValue>
+        FlatIterator(const FlatIterator<OtherTable, OtherValue>& o) : table(o.get_table()), index(o.get_index()) {}
+
+        Value& operator*() const { return table->slot(index); }
+        Value* operator->() const { return &table->slot(index); }
+
+        FlatIterator& operator++()
+        {
+            index = table->next_full(index + 1);
+            return *this;
+        }
+
+        FlatIterator operator++(int)
+        {
+            FlatIterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const FlatIterator& o) const { return index == o.index; }
+        bool operator!=(const FlatIterator& o) const { return index != o.index; }
+
+        Table* get_table() const { return table; }
+        size_t get_index() const { return index; }
+    };
+
+    struct SetKeyOf
+    {
+        template<typename K>
+        const K& operator()(const K& k) const { return k; }
+    };
+
+    struct MapKeyOf
+    {
+        template<typename P>
+        const typename P::first_type& operator()(const P& p) const { return p.first; }
+    };
+}
+
+
+template<typename Key, typename Hash = FlatHash<Key>, typename KeyEqual = std::equal_to<Key>>
+class FlatHashSet
+{
+private:
+    using Table = flat_hash_detail::FlatTable<Key, Key, flat_hash_detail::SetKeyOf, Hash, KeyEqual>;
+    Table table;
+
+public:
+    typedef Key value_type;
+    typedef flat_hash_detail::FlatIterator<const Table, const Key> iterator;    // keys can't be changed in place
+    typedef iterator const_iterator;
+
+    FlatHashSet() = default;
+
+    FlatHashSet(std::initializer_list<Key> keys)
+    {
+        for (const auto& k : keys) insert(k);
+    }
+
+    std::pair<iterator, bool> insert(const Key& k)
+    {
+        auto r = table.find_or_insert(k, [&] { return k; });
+        return {iterator(&table, r.first), r.second};
+    }
+
+    iterator find(const Key& k) const
+    {
+        return iterator(&table, table.find_index(k));
+    }
+
+    size_t count(const Key& k) const
+    {
+        return table.find_index(k) != Table::npos ? 1 : 0;
+    }
+
+    bool contains(const Key& k) const
+    {
+        return table.find_index(k) != Table::npos;
+    }
+
+    size_t erase(const Key& k)
+    {
+        return table.erase_index(table.find_index(k)) ? 1 : 0;
+    }
+
+    // copy every key from o into this set, then empty o
+    void merge(FlatHashSet& o)
+    {
+        reserve(size() + o.size());
+        for (const auto& k : o) insert(k);
+        o.clear();
+    }
+
+    iterator begin() const { return iterator(&table, table.next_full(0)); }
+    iterator end() const { return iterator(&table, Table::npos); }
+
+    size_t size() const { return table.size(); }
+    bool empty() const { return table.size() == 0; }
+
+    void reserve(size_t n) { table.reserve(n); }
+    void clear() { table.clear(); }
+
+    bool operator==(const FlatHashSet& o) const
+    {
+        if (size() != o.size()) return false;
+        for (const auto& k : *this)
+        {
+            if (!o.contains(k)) return false;
+        }
+        return true;
+    }
+
+    bool operator!=(const FlatHashSet& o) const
+    {
+        return !(*this == o);
+    }
+};
+
+
+// the entries are std::pair<Key, Value> rather than std::pair<const Key, Value> so that they can live in a
+// plain vector - don't change a key through an iterator!
+template<typename Key, typename Value, typename Hash = FlatHash<Key>, typename KeyEqual = std::equal_to<Key>>
+class FlatHashMap
+{
+public:
+    typedef std::pair<Key, Value> value_type;
+
+private:
+    using Table = flat_hash_detail::FlatTable<value_type, Key, flat_hash_detail::MapKeyOf, Hash, KeyEqual>;
+    Table table;
+
+public:
+    typedef flat_hash_detail::FlatIterator<Table, value_type> iterator;
+    typedef flat_hash_detail::FlatIterator<const Table, const value_type> const_iterator;
+
+    FlatHashMap() = default;
+
+    Value& operator[](const Key& k)
+    {
+        auto r = table.find_or_insert(k, [&] { return value_type(k, Value()); });
+        return table.slot(r.first).second;
+    }
+
+    std::pair<iterator, bool> insert(const value_type& kv)
+    {
+        auto r = table.find_or_insert(kv.first, [&] { return kv; });
+        return {iterator(&table, r.first), r.second};
+    }
+
+    iterator find(const Key& k)
+    {
+        return iterator(&table, table.find_index(k));
+    }
+
+    const_iterator find(const Key& k) const
+    {
+        return const_iterator(&table, table.find_index(k));
+    }
+
+    size_t count(const Key& k) const
+    {
+        return table.find_index(k) != Table::npos ? 1 : 0;
+    }
+
+    bool contains(const Key& k) const
+    {
+        return table.find_index(k) != Table::npos;
+    }
+
+    size_t erase(const Key& k)
+    {
+        return table.erase_index(table.find_index(k)) ? 1 : 0;
+    }
+
+    iterator begin() { return iterator(&table, table.next_full(0)); }
+    iterator end() { return iterator(&table, Table::npos); }
+    const_iterator begin() const { return const_iterator(&table, table.next_full(0)); }
+    const_iterator end() const { return const_iterator(&table, Table::npos); }
+
+    size_t size() const { return table.size(); }
+    bool empty() const { return table.size() == 0; }
+
+    void reserve(size_t n) { table.reserve(n); }
+    void clear() { table.clear(); }
+
+    bool operator==(const FlatHashMap& o) const
+    {
+        if (size() != o.size()) return false;
+        for (const auto& kv : *this)
+        {
+            auto iter = o.find(kv.first);
+            if (iter == o.end() || !(iter->second == kv.second)) return false;
+        }
+        return true;
+    }
+
+    bool operator!=(const FlatHashMap& o) const
+    {
+        return !(*this == o);
+    }
+};
+
+
+#endif //AOC2018_FLAT_HASH_H
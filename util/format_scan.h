@@ -0,0 +1,165 @@
+//
+// Created by wuggy on 17/10/26.
+//
+
+#ifndef AOC2018_FORMAT_SCAN_H
+#define AOC2018_FORMAT_SCAN_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "field_scanner.h"
+
+// Scan a line against a fixed pattern, where each "{}" is a field to read into the matching argument:
+//
+//     static constexpr char bot_format[] = "pos=<{},{},{}>, r={}";
+//     bool matched = scan<bot_format>(line, b.point[0], b.point[1], b.point[2], b.r);
+//
+// The pattern is a template argument (so it has to be a constexpr char array with static storage), and it's checked
+// at compile time against the number of arguments. Each literal run in the pattern is matched with a single
+// fixed-length compare, a space in the pattern matches any run of whitespace, and fields read like FieldScanner
+// fields (integers, single chars or string_view tokens, skipping leading whitespace).
+// Anything after the end of the pattern is ignored.
+//
+// scan() says whether the line matched; scan_or_throw() is for lines that have to match, and throws a
+// std::runtime_error (naming the pattern and the line) if one doesn't.
+
+namespace format_scan_detail
+{
+    constexpr size_t length(const char* p)
+    {
+        size_t n = 0;
+        while (p[n]) ++n;
+        return n;
+    }
+
+    constexpr bool is_valid(const char* p)
+    {
+        // every '{' must be the start of a "{}", and there can't be any stray '}'
+        for (size_t i = 0; p[i]; ++i)
+        {
+            if (p[i] == '{')
+            {
+                if (p[i + 1] != '}') return false;
+                ++i;
+            }
+            else if (p[i] == '}') return false;
+        }
+        return true;
+    }
+
+    constexpr size_t count_fields(const char* p)
+    {
+        size_t n = 0;
+        for (size_t i = 0; p[i]; ++i)
+        {
+            if (p[i] == '{') ++n;
+        }
+        return n;
+    }
+
+    constexpr size_t next_field(const char* p, size_t i)
+    {
+        // the index of the next "{}", or the end of the pattern
+        while (p[i] && p[i] != '{') ++i;
+        return i;
+    }
+
+    constexpr size_t next_space(const char* p, size_t i, size_t end)
+    {
+        while (i < end && p[i] != ' ') ++i;
+        return i;
+    }
+
+    constexpr size_t skip_spaces(const char* p, size_t i, size_t end)
+    {
+        while (i < end && p[i] == ' ') ++i;
+        return i;
+    }
+
+
+    template<const char* Pattern, size_t Begin, size_t End>
+    bool scan_literal(FieldScanner& s)
+    {
+        if constexpr (Begin < End)
+        {
+            if constexpr (Pattern[Begin] == ' ')
+            {
+                s.skip_whitespace();
+                return scan_literal<Pattern, skip_spaces(Pattern, Begin, End), End>(s);
+            }
+            else
+            {
+                constexpr size_t run_end = next_space(Pattern, Begin, End);
+                constexpr std::string_view run(Pattern + Begin, run_end - Begin);
+
+                if (!s.exact(run)) return false;
+                return scan_literal<Pattern, run_end, End>(s);
+            }
+        }
+        else
+        {
+            return true;
+        }
+    }
+
+    template<const char* Pattern, size_t Begin>
+    bool scan_fields(FieldScanner& s)
+    {
+        return scan_literal<Pattern, Begin, length(Pattern)>(s);
+    }
+
+    template<const char* Pattern, size_t Begin, typename Arg, typename... Args>
+    bool scan_fields(FieldScanner& s, Arg& arg, Args&... args)
+    {
+        constexpr size_t field = next_field(Pattern, Begin);
+        if (!scan_literal<Pattern, Begin, field>(s)) return false;
+
+        s >> arg;
+        if (!s) return false;
+
+        return scan_fields<Pattern, field + 2>(s, args...);   // skip the "{}"
+    }
+}
+
+
+template<const char* Pattern, typename... Args>
+bool scan(std::string_view line, Args&... args)
+{
+    static_assert(format_scan_detail::is_valid(Pattern), "scan pattern has a '{' or '}' that isn't part of a {} field");
+    static_assert(format_scan_detail::count_fields(Pattern) == sizeof...(Args), "scan pattern and arguments have a different number of fields");
+
+    FieldScanner s(line);
+    return format_scan_detail::scan_fields<Pattern, 0>(s, args...);
+}
+
+
+template<const char* Pattern, typename... Args>
+void scan_or_throw(std::string_view line, Args&... args)
+{
+    if (!scan<Pattern>(line, args...))
+    {
+        throw std::runtime_error("Line doesn't match \"" + std::string(Pattern) + "\": " + std::string(line));
+    }
+}
+
+
+// make a converter for convert_strings which scans each line into the given members of a fresh T
+//     convert_strings<claim>(lines, record_parser<claim_format>(&claim::id, &claim::x, ...));
+template<const char* Pattern, typename T, typename... Fields>
+auto record_parser(Fields T::*... fields)
+{
+    return [=](std::string_view line) -> T
+    {
+        T record{};
+
+        scan_or_throw<Pattern>(line, (record.*fields)...);
+
+        return record;
+    };
+}
+
+
+#endif //AOC2018_FORMAT_SCAN_H
@@ -5,6 +5,16 @@
 #ifndef AOC2018_GRID_H
 #define AOC2018_GRID_H
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "hash.h"
+
 struct Point {
     int x;
     int y;
@@ -40,215 +50,532 @@ namespace std
         typedef std::size_t result_type;
         result_type operator()(argument_type const& p) const noexcept
         {
-            constexpr result_type m = 24251;
-            return std::hash<int>()(p.x) + std::hash<int>()(p.y) * m;
+            return hash_mix(pack_ints(p.x, p.y));
         }
     };
 }
 
 
+// A fixed-size grid in a single contiguous allocation, for when the size is known up front.
+// It can have a halo: a border of extra cells around the outside (filled with the default item) so that
+// reading the neighbours of an edge cell needs no bounds check. Rows and columns run from 0, and the halo
+// cells are at -halo..-1 and rows()..rows()+halo-1 (and the same for columns).
 template<typename T>
-class NoddySparseGrid
+class DenseGrid
 {
 private:
-    const T default_item;
-    std::vector<std::vector<T>> grid;
-    std::vector<T> dummy_row;   // used for const RowAccessors to out-of-bound rows
+    size_t width = 0;
+    size_t height = 0;
+    size_t border = 0;
+    size_t row_stride = 0;
+    std::vector<T> cells;
 
-    size_t max_col = 0;
+    size_t origin() const
+    {
+        return border * row_stride + border;
+    }
 
 public:
-    explicit NoddySparseGrid(const T& item = T()) : default_item(item) {}
+    typedef std::ptrdiff_t index_type;
 
-    NoddySparseGrid(const NoddySparseGrid&) = default;
-    NoddySparseGrid(NoddySparseGrid&&) noexcept = default;
+    DenseGrid() = default;
 
-    NoddySparseGrid& operator=(const NoddySparseGrid&) = default;
-    NoddySparseGrid& operator=(NoddySparseGrid&&) noexcept = default;
+    DenseGrid(size_t columns, size_t rows, const T& item = T(), size_t halo = 0)
+        : width(columns), height(rows), border(halo), row_stride(columns + 2 * halo),
+          cells((rows + 2 * halo) * (columns + 2 * halo), item)
+        {}
 
-    class RowAccessor
+    DenseGrid(const DenseGrid&) = default;
+    DenseGrid(DenseGrid&&) noexcept = default;
+
+    DenseGrid& operator=(const DenseGrid&) = default;
+    DenseGrid& operator=(DenseGrid&&) noexcept = default;
+
+    // a pointer to column 0 of a row, so g[y][x] works for any x in -halo..columns()+halo-1
+    T* operator[](index_type y)
     {
-    private:
-        const T &default_item;
-        std::vector<T> &row;
-        size_t& max_col;
+        return row(y);
+    }
 
-    public:
-        RowAccessor(const T &item, std::vector<T> &r, size_t& mc) : default_item(item), row(r), max_col(mc) {}
-        RowAccessor(const RowAccessor &) = default;
-        RowAccessor(RowAccessor &&) noexcept = default;
+    const T* operator[](index_type y) const
+    {
+        return row(y);
+    }
 
-        T &operator[](size_t i)
-        {
-            max_col = std::max(max_col, i);
+    T& operator[](const Point& p)
+    {
+        return row(p.y)[p.x];
+    }
 
-            if (i >= row.size()) row.resize(i + 1, default_item);
-            return row[i];
-        }
-    };
+    const T& operator[](const Point& p) const
+    {
+        return row(p.y)[p.x];
+    }
 
+    T* row(index_type y)
+    {
+        assert(y >= -index_type(border) && y < index_type(height + border));
+        return cells.data() + origin() + y * index_type(row_stride);
+    }
 
-    class ConstRowAccessor
+    const T* row(index_type y) const
     {
-    private:
-        const T &default_item;
-        const std::vector<T> &row;
+        assert(y >= -index_type(border) && y < index_type(height + border));
+        return cells.data() + origin() + y * index_type(row_stride);
+    }
 
-    public:
-        ConstRowAccessor(const T &item, const std::vector<T> &r) : default_item(item), row(r) {}
-        ConstRowAccessor(const ConstRowAccessor &) = default;
-        ConstRowAccessor(ConstRowAccessor &&) noexcept = default;
+    // the cells of a row, from its first to its last column (not including the halo)
+    T* row_begin(index_type y)              { return row(y); }
+    T* row_end(index_type y)                { return row(y) + width; }
+    const T* row_begin(index_type y) const  { return row(y); }
+    const T* row_end(index_type y) const    { return row(y) + width; }
+
+    // is p inside the grid proper (not the halo)?
+    bool contains(const Point& p) const
+    {
+        return p.x >= 0 && p.y >= 0 && size_t(p.x) < width && size_t(p.y) < height;
+    }
+
+    // the distance (in cells) between the same column of neighbouring rows, for stepping around with pointers
+    size_t stride() const
+    {
+        return row_stride;
+    }
 
-        const T& operator[](size_t i) const
+    size_t halo() const
+    {
+        return border;
+    }
+
+    // every cell (halo included) has a flat index in 0..cell_count()-1, for keying per-cell side tables
+    size_t cell_count() const
+    {
+        return cells.size();
+    }
+
+    size_t index_of(const Point& p) const
+    {
+        return origin() + p.y * index_type(row_stride) + p.x;
+    }
+
+    Point point_at(size_t index) const
+    {
+        return Point(index_type(index % row_stride) - index_type(border), index_type(index / row_stride) - index_type(border));
+    }
+
+    T& at_index(size_t index)               { return cells[index]; }
+    const T& at_index(size_t index) const   { return cells[index]; }
+
+    size_t rows() const
+    {
+        return height;
+    }
+
+    size_t columns() const
+    {
+        return width;
+    }
+
+    // fill the whole grid, halo and all
+    void fill(const T& item)
+    {
+        std::fill(cells.begin(), cells.end(), item);
+    }
+
+    bool operator==(const DenseGrid& o) const
+    {
+        return width == o.width && height == o.height && border == o.border && cells == o.cells;
+    }
+
+    bool operator!=(const DenseGrid& o) const
+    {
+        return !(*this == o);
+    }
+};
+
+
+// A fixed-size grid of small cells, packed into 1, 2 or 4-bit lanes of 64-bit words.
+// Each row starts on a fresh word, and the lanes past the end of a row are always kept zero, so whole rows
+// can be worked on a word at a time (cell x of a row is lane x % lanes_per_word of word x / lanes_per_word,
+// with lane 0 in the lowest bits).
+template<unsigned Bits>
+class PackedGrid
+{
+    static_assert(Bits == 1 || Bits == 2 || Bits == 4, "PackedGrid cells must be 1, 2 or 4 bits");
+
+public:
+    typedef uint64_t word_type;
+
+    static constexpr unsigned lanes_per_word = 64 / Bits;
+    static constexpr word_type lane_mask = (word_type(1) << Bits) - 1;
+
+    // the lowest bit of every lane (0x5555... for 2-bit lanes), for building whole-word masks
+    static constexpr word_type low_bits = ~word_type(0) / lane_mask;
+
+private:
+    size_t width = 0;
+    size_t height = 0;
+    size_t row_words = 0;
+    std::vector<word_type> words;
+
+public:
+    PackedGrid() = default;
+
+    PackedGrid(size_t columns, size_t rows, unsigned item = 0)
+        : width(columns), height(rows), row_words((columns + lanes_per_word - 1) / lanes_per_word),
+          words(row_words * rows, (item & lane_mask) * low_bits)
+    {
+        // clear the lanes past the end of each row
+        if (row_words > 0)
         {
-            if (i>=row.size()) return default_item;
-            return row[i];
+            for (size_t y = 0; y < height; ++y) row(y)[row_words - 1] &= last_word_mask();
         }
-    };
+    }
+
+    PackedGrid(const PackedGrid&) = default;
+    PackedGrid(PackedGrid&&) noexcept = default;
 
+    PackedGrid& operator=(const PackedGrid&) = default;
+    PackedGrid& operator=(PackedGrid&&) noexcept = default;
 
-    RowAccessor operator[](size_t i)
+    unsigned get(size_t x, size_t y) const
     {
-        if (i>=grid.size()) grid.resize(i + 1);
-        return RowAccessor(default_item, grid[i], max_col);
+        assert(x < width && y < height);
+        return unsigned(row(y)[x / lanes_per_word] >> ((x % lanes_per_word) * Bits)) & lane_mask;
     }
 
-    ConstRowAccessor operator[](size_t i) const
+    void set(size_t x, size_t y, unsigned v)
     {
-        if (i>=grid.size()) return ConstRowAccessor(default_item, dummy_row);
-        return ConstRowAccessor(default_item, grid[i]);
+        assert(x < width && y < height);
+        assert(v <= lane_mask);
+
+        word_type& w = row(y)[x / lanes_per_word];
+        const unsigned shift = (x % lanes_per_word) * Bits;
+        w = (w & ~(lane_mask << shift)) | (word_type(v) << shift);
     }
 
-    T& operator[](const Point& p)
+    unsigned get(const Point& p) const
     {
-        return (*this)[p.y][p.x];
+        return get(p.x, p.y);
     }
 
-    const T& operator[](const Point& p) const
+    void set(const Point& p, unsigned v)
+    {
+        set(p.x, p.y, v);
+    }
+
+    // the words of a row, words_per_row() of them
+    word_type* row(size_t y)
+    {
+        assert(y < height);
+        return words.data() + y * row_words;
+    }
+
+    const word_type* row(size_t y) const
     {
-        return (*this)[p.y][p.x];
+        assert(y < height);
+        return words.data() + y * row_words;
+    }
+
+    size_t words_per_row() const
+    {
+        return row_words;
+    }
+
+    // the lanes of the last word of a row which are actually in the grid
+    word_type last_word_mask() const
+    {
+        const size_t used = width - (row_words - 1) * lanes_per_word;
+        return used * Bits == 64 ? ~word_type(0) : (word_type(1) << (used * Bits)) - 1;
     }
 
     size_t rows() const
     {
-        return grid.size();
+        return height;
     }
 
     size_t columns() const
     {
-        return max_col + 1; // max_col is the max filled column
+        return width;
     }
 
+    bool operator==(const PackedGrid& o) const
+    {
+        return width == o.width && height == o.height && words == o.words;
+    }
+
+    bool operator!=(const PackedGrid& o) const
+    {
+        return !(*this == o);
+    }
 };
 
-template<typename T>
-class OriginCenteredGrid
+
+// A sparse grid that can grow in any direction, stored as fixed-size square pages (64x64 cells by default)
+// which are only allocated when a cell in them is written. A hash directory maps page coordinates to pages,
+// so point access is O(1) and memory is proportional to the area that's actually touched, wherever it is.
+// Reading an unallocated cell through a const grid gives the default item without allocating anything.
+template<typename T, unsigned PageBits = 6>
+class PagedGrid
 {
+public:
+    typedef int64_t index_type;
+
+    static constexpr index_type page_size = index_type(1) << PageBits;
+
+    // a page of cells, with x0/y0 the grid coordinates of its top-left cell
+    struct Page
+    {
+        index_type x0;
+        index_type y0;
+        std::vector<T> cells;
+
+        const T& at(index_type lx, index_type ly) const     // local coordinates, 0..page_size-1
+        {
+            return cells[ly * page_size + lx];
+        }
+
+        T& at(index_type lx, index_type ly)
+        {
+            return cells[ly * page_size + lx];
+        }
+    };
+
 private:
-    NoddySparseGrid<T> posx_posy_grid;
-    NoddySparseGrid<T> negx_posy_grid;
-    NoddySparseGrid<T> posx_negy_grid;
-    NoddySparseGrid<T> negx_negy_grid;
+    // the page coordinates (the cell coordinates floor divided by the page size), kept whole so that however far
+    // apart two pages are, they never share a key
+    struct PageKey
+    {
+        index_type px = 0;
+        index_type py = 0;
+
+        bool operator==(const PageKey& o) const
+        {
+            return px == o.px && py == o.py;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const PageKey& k) const noexcept
+        {
+            // the keys are very regular, so mix them up before they're bucketed
+            return hash_combine(hash_mix(uint64_t(k.px)), uint64_t(k.py));
+        }
+    };
+
+    T default_item;
+    std::vector<Page> grid_pages;
+    std::unordered_map<PageKey, size_t, KeyHash> directory;   // page key -> index into grid_pages
+
+    // a small direct-mapped cache of recently used pages in front of the directory, since accesses
+    // are usually close together (this makes even const lookups unsafe to share between threads)
+    static constexpr size_t cache_size = 8;
+    struct CacheEntry
+    {
+        PageKey key;
+        size_t index = ~size_t(0);  // every key is a valid page, so an empty entry has an invalid index instead
+    };
+    mutable std::array<CacheEntry, cache_size> cache;
+
+    index_type min_y = 0, max_y = -1;
+    index_type min_x = 0, max_x = -1;
+
+    static PageKey page_key(index_type x, index_type y)
+    {
+        // floor division by the page size, for negative coordinates too
+        return {x >> PageBits, y >> PageBits};
+    }
+
+    static index_type local(index_type i)
+    {
+        return i & (page_size - 1);
+    }
+
+    static size_t cache_slot(const PageKey& key)
+    {
+        // neighbouring pages land in different slots
+        return size_t(key.py * 3 + key.px) & (cache_size - 1);
+    }
+
+    const Page* find_page(index_type x, index_type y) const
+    {
+        const PageKey key = page_key(x, y);
+        CacheEntry& cached = cache[cache_slot(key)];
+        if (cached.key == key && cached.index < grid_pages.size()) return &grid_pages[cached.index];
+
+        auto iter = directory.find(key);
+        if (iter == directory.end()) return nullptr;
+
+        cached = {key, iter->second};
+        return &grid_pages[iter->second];
+    }
+
+    Page& get_page(index_type x, index_type y)
+    {
+        const PageKey key = page_key(x, y);
+        CacheEntry& cached = cache[cache_slot(key)];
+        if (cached.key == key && cached.index < grid_pages.size()) return grid_pages[cached.index];
+
+        auto insert_pair = directory.emplace(key, grid_pages.size());
+        if (insert_pair.second)
+        {
+            // a new page, filled with the default item
+            grid_pages.push_back(Page{x - local(x), y - local(y), std::vector<T>(page_size * page_size, default_item)});
+        }
+
+        cached = {key, insert_pair.first->second};
+        return grid_pages[cached.index];
+    }
+
+    void extend_bounds(index_type x, index_type y)
+    {
+        if (max_y < min_y)
+        {
+            // the first cell to be touched
+            min_x = max_x = x;
+            min_y = max_y = y;
+            return;
+        }
+
+        min_x = std::min(min_x, x);
+        max_x = std::max(max_x, x);
+        min_y = std::min(min_y, y);
+        max_y = std::max(max_y, y);
+    }
 
 public:
-    typedef int64_t index_type;
+    explicit PagedGrid(const T& item = T()) : default_item(item) {}
 
-    explicit OriginCenteredGrid(const T& item = T())
-        : posx_posy_grid(item), negx_posy_grid(item),
-          posx_negy_grid(item), negx_negy_grid(item)
-        {}
+    PagedGrid(const PagedGrid&) = default;
+    PagedGrid(PagedGrid&&) noexcept = default;
 
-    OriginCenteredGrid(const OriginCenteredGrid&) = default;
-    OriginCenteredGrid(OriginCenteredGrid&&) noexcept = default;
+    PagedGrid& operator=(const PagedGrid&) = default;
+    PagedGrid& operator=(PagedGrid&&) noexcept = default;
 
-    OriginCenteredGrid& operator=(const OriginCenteredGrid&) = default;
-    OriginCenteredGrid& operator=(OriginCenteredGrid&&) noexcept = default;
+    // get a cell, allocating its page if needed (the cell counts towards the bounds from then on)
+    T& at(index_type x, index_type y)
+    {
+        extend_bounds(x, y);
+        return get_page(x, y).at(local(x), local(y));
+    }
 
+    const T& at(index_type x, index_type y) const
+    {
+        const Page* page = find_page(x, y);
+        if (!page) return default_item;
+        return page->at(local(x), local(y));
+    }
 
     class RowAccessor
     {
     private:
-        typename NoddySparseGrid<T>::RowAccessor posx_accessor;
-        typename NoddySparseGrid<T>::RowAccessor negx_accessor;
+        PagedGrid& grid;
+        index_type y;
 
     public:
-        RowAccessor(typename NoddySparseGrid<T>::RowAccessor&& posx_a, typename NoddySparseGrid<T>::RowAccessor&& negx_a)
-            : posx_accessor(posx_a), negx_accessor(negx_a) {}
-
-        RowAccessor(const RowAccessor &) = default;
-        RowAccessor(RowAccessor &&) noexcept = default;
+        RowAccessor(PagedGrid& g, index_type ay) : grid(g), y(ay) {}
 
-        T& operator[](index_type i)
+        T& operator[](index_type x)
         {
-            if (i>=0) return posx_accessor[i];
-            else return negx_accessor[-i];
+            return grid.at(x, y);
         }
     };
 
     class ConstRowAccessor
     {
     private:
-        typename NoddySparseGrid<T>::ConstRowAccessor posx_accessor;
-        typename NoddySparseGrid<T>::ConstRowAccessor negx_accessor;
+        const PagedGrid& grid;
+        index_type y;
 
     public:
-        ConstRowAccessor(typename NoddySparseGrid<T>::ConstRowAccessor&& posx_a, typename NoddySparseGrid<T>::ConstRowAccessor&& negx_a)
-                : posx_accessor(posx_a), negx_accessor(negx_a) {}
-
-        ConstRowAccessor(const ConstRowAccessor &) = default;
-        ConstRowAccessor(ConstRowAccessor &&) noexcept = default;
+        ConstRowAccessor(const PagedGrid& g, index_type ay) : grid(g), y(ay) {}
 
-        const T& operator[](index_type i) const
+        const T& operator[](index_type x) const
         {
-            if (i>=0) return posx_accessor[i];
-            else return negx_accessor[-i];
+            return grid.at(x, y);
         }
     };
 
-    RowAccessor operator[](index_type i)
+    RowAccessor operator[](index_type y)
     {
-        if (i>=0) return RowAccessor(posx_posy_grid[i], negx_posy_grid[i]);
-        else return RowAccessor(posx_negy_grid[-i], negx_negy_grid[-i]);
+        return RowAccessor(*this, y);
     }
 
-    ConstRowAccessor operator[](index_type i) const
+    ConstRowAccessor operator[](index_type y) const
     {
-        if (i>=0) return ConstRowAccessor(posx_posy_grid[i], negx_posy_grid[i]);
-        else return ConstRowAccessor(posx_negy_grid[-i], negx_negy_grid[-i]);
+        return ConstRowAccessor(*this, y);
     }
 
     T& operator[](const Point& p)
     {
-        return (*this)[p.y][p.x];
+        return at(p.x, p.y);
     }
 
     const T& operator[](const Point& p) const
     {
-        return (*this)[p.y][p.x];
+        return at(p.x, p.y);
+    }
+
+    // the allocated pages, in no particular order
+    // (every cell outside them is the default item)
+    const std::vector<Page>& pages() const
+    {
+        return grid_pages;
     }
 
-    index_type min_row() const  // inclusive!
+    // the cells of the allocated pages numbered densely, a page at a time (from 0 to allocated_cell_count() - 1),
+    // so that things indexed by cell - a search's visited and distance arrays, say - only need as much room as
+    // the parts of the grid that have been touched, rather than its whole bounding box
+    static constexpr size_t no_cell = ~size_t(0);
+
+    size_t allocated_cell_count() const
     {
-        return -(std::max(posx_negy_grid.rows(), negx_negy_grid.rows()) - 1);
+        return grid_pages.size() * size_t(page_size * page_size);
     }
 
-    index_type max_row() const  // inclusive!
+    // the number of a cell, or no_cell if its page was never allocated
+    size_t cell_number(index_type x, index_type y) const
     {
-        return std::max(posx_posy_grid.rows(), negx_posy_grid.rows()) - 1;
+        const Page* page = find_page(x, y);
+        if (!page) return no_cell;
+        return size_t(page - grid_pages.data()) * size_t(page_size * page_size) + size_t(local(y) * page_size + local(x));
     }
 
-    index_type min_column() const  // inclusive!
+    // and back again
+    Point cell_at_number(size_t n) const
     {
-        return -(std::max(negx_posy_grid.columns(), negx_negy_grid.columns()) - 1);
+        const Page& page = grid_pages[n / size_t(page_size * page_size)];
+        const auto offset = index_type(n % size_t(page_size * page_size));
+        return Point(int(page.x0 + offset % page_size), int(page.y0 + offset / page_size));
     }
 
-    index_type max_column() const  // inclusive!
+    // the bounds of every cell accessed through a non-const grid
+    // these are all inclusive, and an empty grid has max < min
+    index_type min_row() const
     {
-        return std::max(posx_posy_grid.columns(), posx_negy_grid.columns()) - 1;
+        return min_y;
     }
 
+    index_type max_row() const
+    {
+        return max_y;
+    }
 
+    index_type min_column() const
+    {
+        return min_x;
+    }
+
+    index_type max_column() const
+    {
+        return max_x;
+    }
 };
 
+// a grid that grows in every direction from the origin
+template<typename T>
+using OriginCenteredGrid = PagedGrid<T>;
+
 
 #endif //AOC2018_GRID_H
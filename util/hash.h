@@ -0,0 +1,40 @@
+//
+// Created by wuggy on 17/10/26.
+//
+
+#ifndef AOC2018_HASH_H
+#define AOC2018_HASH_H
+
+#include <cstdint>
+
+// Hash helpers for keys made of a few small integers.
+// Puzzle coordinates are small and close together, so anything that just adds or multiplies the fields
+// together leaves most of the bits of the hash the same - every bit of the input needs to reach every bit
+// of the output before a hash table uses it.
+
+
+// scramble all the bits of a 64-bit value (the splitmix64 finaliser)
+inline uint64_t hash_mix(uint64_t h)
+{
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebull;
+    h ^= h >> 31;
+    return h;
+}
+
+// fold another value into a hash
+inline uint64_t hash_combine(uint64_t seed, uint64_t v)
+{
+    return hash_mix(seed ^ (v + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2)));
+}
+
+// pack two 32-bit ints into one 64-bit value, so a 2d point can be mixed in one go
+inline uint64_t pack_ints(int a, int b)
+{
+    return (uint64_t(uint32_t(a)) << 32) | uint32_t(b);
+}
+
+
+#endif //AOC2018_HASH_H
@@ -0,0 +1,163 @@
+//
+// Created by wuggy on 17/10/26.
+//
+
+#ifndef AOC2018_INPUT_CACHE_H
+#define AOC2018_INPUT_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <unistd.h>
+
+#include "file_parsing.h"
+
+// An opt-in cache of already-parsed inputs.
+// If AOC_INPUT_CACHE names a directory, the parsed records for an input are written there as a flat binary blob,
+// keyed by a hash of the raw input text. The next run with the same input maps the blob back in rather than parsing.
+// Without AOC_INPUT_CACHE set, everything is just parsed as normal.
+//
+// Each caller gives a format version for its records, to be bumped whenever its parser or record type changes,
+// so that a blob written by an older build is a miss rather than being loaded as if it were the new records.
+
+
+// a quick 64-bit hash of some bytes, eight at a time
+inline uint64_t hash_bytes(std::string_view s)
+{
+    constexpr uint64_t m = 0x9e3779b97f4a7c15ull;
+
+    uint64_t h = s.size() * m;
+    size_t i = 0;
+    for (; i + 8 <= s.size(); i += 8)
+    {
+        uint64_t v;
+        std::memcpy(&v, s.data() + i, sizeof(v));
+        h = (h ^ v) * m;
+        h ^= h >> 32;
+    }
+
+    uint64_t tail = 0;
+    if (i < s.size()) std::memcpy(&tail, s.data() + i, s.size() - i);     // (an empty view's data can be null)
+    h = (h ^ tail) * m;
+
+    // final avalanche (the murmur3 finaliser)
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+
+struct InputCacheHeader
+{
+    static constexpr uint64_t expected_magic = 0x32454843434f41ull;    // "AOCCHE2"
+
+    uint64_t magic = expected_magic;
+    uint64_t format_version = 0;
+    uint64_t input_hash = 0;
+    uint64_t input_size = 0;
+    uint64_t record_size = 0;
+    uint64_t record_count = 0;
+};
+
+
+// the path of the cache blob for this input, or an empty string if caching is turned off
+inline std::string input_cache_path(const std::string& tag, uint64_t input_hash)
+{
+    const char* dir = std::getenv("AOC_INPUT_CACHE");
+    if (!dir || !*dir) return {};
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "-%016llx.bin", static_cast<unsigned long long>(input_hash));
+    return std::string(dir) + "/" + tag + name;
+}
+
+
+// a name for a temporary file next to path that no other writer - in this process or another - will pick
+inline std::string input_cache_temp_path(const std::string& path)
+{
+    static std::atomic<uint64_t> sequence{0};
+    return path + "." + std::to_string(getpid()) + "." + std::to_string(sequence++) + ".tmp";
+}
+
+
+// load the records parsed from raw_input from the cache, or parse them with parse() and cache them for next time
+// tag names the record type in the cache (e.g. "day03-claims"), so different parses of the same text don't collide,
+// and format_version is that record type's version (see above)
+template<typename T, typename Parser>
+std::vector<T> load_cached_records(std::string_view raw_input, const std::string& tag, uint64_t format_version,
+                                   Parser&& parse)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable records can be cached as flat arrays");
+
+    const uint64_t input_hash = hash_bytes(raw_input);
+    const std::string path = input_cache_path(tag, input_hash);
+    if (path.empty()) return parse();
+
+    // try the cache first - anything that doesn't look exactly right is a miss
+    if (access(path.c_str(), R_OK) == 0)
+    {
+        MappedFile blob(path);
+        std::string_view bytes = blob.text();
+
+        InputCacheHeader header;
+        if (bytes.size() >= sizeof(header))
+        {
+            std::memcpy(&header, bytes.data(), sizeof(header));
+
+            if (header.magic == InputCacheHeader::expected_magic &&
+                header.format_version == format_version &&
+                header.input_hash == input_hash &&
+                header.input_size == raw_input.size() &&
+                header.record_size == sizeof(T) &&
+                (bytes.size() - sizeof(header)) % sizeof(T) == 0 &&
+                header.record_count == (bytes.size() - sizeof(header)) / sizeof(T))    // (a corrupt count can't overflow)
+            {
+                std::vector<T> records(header.record_count);
+                if (!records.empty()) std::memcpy(records.data(), bytes.data() + sizeof(header), header.record_count * sizeof(T));
+                return records;
+            }
+        }
+    }
+
+    // missed, so parse and write the blob out for the next run
+    std::vector<T> records = parse();
+
+    InputCacheHeader header;
+    header.format_version = format_version;
+    header.input_hash = input_hash;
+    header.input_size = raw_input.size();
+    header.record_size = sizeof(T);
+    header.record_count = records.size();
+
+    // write to a temporary and rename, so a concurrent reader never sees half a blob
+    // (and each writer has its own temporary, as aocd and batch mode can parse the same input on two threads at once)
+    const std::string temp_path = input_cache_temp_path(path);
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(T)));
+        if (!out)
+        {
+            // couldn't write the cache, but we've still got the answer
+            std::remove(temp_path.c_str());
+            return records;
+        }
+    }
+    std::rename(temp_path.c_str(), path.c_str());
+
+    return records;
+}
+
+
+#endif //AOC2018_INPUT_CACHE_H
@@ -0,0 +1,183 @@
+#include "line_stream.h"
+
+#include <cassert>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+
+ChunkReader::ChunkReader(const std::string& filename, size_t chunk_size) : buffer(chunk_size)
+{
+    assert(chunk_size > 0);
+
+    fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Failed to open " + filename);
+
+    // we're going to read it front to back, so let the kernel read ahead
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+}
+
+ChunkReader::~ChunkReader()
+{
+    if (fd >= 0) close(fd);
+}
+
+ChunkReader::ChunkReader(ChunkReader&& o) noexcept : fd(o.fd), buffer(std::move(o.buffer))
+{
+    o.fd = -1;
+}
+
+ChunkReader& ChunkReader::operator=(ChunkReader&& o) noexcept
+{
+    std::swap(fd, o.fd);
+    std::swap(buffer, o.buffer);
+    return *this;
+}
+
+std::string_view ChunkReader::next()
+{
+    if (fd < 0) return {};
+
+    // fill the whole buffer if we can, read() is allowed to hand back less than we asked for
+    size_t filled = 0;
+    while (filled < buffer.size())
+    {
+        ssize_t n = read(fd, buffer.data() + filled, buffer.size() - filled);
+        if (n < 0 && errno == EINTR) continue;
+        assert(n >= 0);
+        if (n <= 0) break;  // end of file (or an error, which we treat the same)
+
+        filled += static_cast<size_t>(n);
+    }
+
+    return {buffer.data(), filled};
+}
+
+
+LineStream::LineStream(const std::string& filename, size_t chunk_size) : reader(filename, chunk_size)
+{
+}
+
+bool LineStream::next(std::string_view& line)
+{
+    // the last line we handed out was the carried one, so we're done with it now
+    if (carry_used)
+    {
+        carry.clear();
+        carry_used = false;
+    }
+
+    while (true)
+    {
+        if (pos == chunk.size())
+        {
+            chunk = reader.next();
+            pos = 0;
+
+            if (chunk.empty())
+            {
+                // a last line without a trailing '\n'
+                if (carry.empty()) return false;
+
+                line = carry;
+                carry_used = true;
+                return true;
+            }
+        }
+
+        auto nl = static_cast<const char*>(std::memchr(chunk.data() + pos, '\n', chunk.size() - pos));
+        if (!nl)
+        {
+            // the line runs into the next chunk, so hang on to what we've got of it
+            carry.append(chunk.substr(pos));
+            pos = chunk.size();
+            continue;
+        }
+
+        size_t end = static_cast<size_t>(nl - chunk.data());
+        if (carry.empty())
+        {
+            line = chunk.substr(pos, end - pos);    // the common case, the whole line is in this chunk
+        }
+        else
+        {
+            carry.append(chunk.substr(pos, end - pos));
+            line = carry;
+            carry_used = true;
+        }
+
+        pos = end + 1;
+        return true;
+    }
+}
+
+
+TokenStream::TokenStream(const std::string& filename, size_t chunk_size) : reader(filename, chunk_size)
+{
+}
+
+bool TokenStream::next(std::string_view& token)
+{
+    // the last token we handed out was the carried one, so we're done with it now
+    if (carry_used)
+    {
+        carry.clear();
+        carry_used = false;
+    }
+
+    auto is_space = [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; };
+
+    while (true)
+    {
+        if (pos == chunk.size())
+        {
+            chunk = reader.next();
+            pos = 0;
+
+            if (chunk.empty())
+            {
+                // a last token without any whitespace after it
+                if (carry.empty()) return false;
+
+                token = carry;
+                carry_used = true;
+                return true;
+            }
+        }
+
+        // skip the whitespace before a token (but whitespace straight after a carried token ends it)
+        if (carry.empty())
+        {
+            while (pos < chunk.size() && is_space(chunk[pos])) ++pos;
+            if (pos == chunk.size()) continue;
+        }
+
+        size_t start = pos;
+        while (pos < chunk.size() && !is_space(chunk[pos])) ++pos;
+
+        if (pos == chunk.size())
+        {
+            // the token runs into the next chunk, so hang on to what we've got of it
+            carry.append(chunk.substr(start));
+            continue;
+        }
+
+        if (carry.empty())
+        {
+            token = chunk.substr(start, pos - start);
+        }
+        else
+        {
+            carry.append(chunk.substr(start, pos - start));
+            token = carry;
+            carry_used = true;
+        }
+
+        return true;
+    }
+}
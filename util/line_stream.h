@@ -0,0 +1,79 @@
+//
+// Created by wuggy on 17/10/26.
+//
+
+#ifndef AOC2018_LINE_STREAM_H
+#define AOC2018_LINE_STREAM_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Readers for inputs too big to hold in memory at once.
+// They only ever hold one fixed-size chunk of the file (plus whatever line or token straddles two chunks),
+// so single-pass solvers can run over multi-GB inputs in bounded memory.
+// Every view they hand out is only valid until the next call on the same reader.
+
+
+// reads a file a fixed-size chunk at a time (throwing a std::runtime_error if it can't be opened)
+class ChunkReader
+{
+private:
+    int fd = -1;
+    std::vector<char> buffer;
+
+public:
+    static constexpr size_t default_chunk_size = 1 << 20;
+
+    explicit ChunkReader(const std::string& filename, size_t chunk_size = default_chunk_size);
+    ~ChunkReader();
+
+    ChunkReader(const ChunkReader&) = delete;
+    ChunkReader(ChunkReader&& o) noexcept;
+
+    ChunkReader& operator=(const ChunkReader&) = delete;
+    ChunkReader& operator=(ChunkReader&& o) noexcept;
+
+    // the next chunk of the file, or an empty view once it's all been read
+    std::string_view next();
+};
+
+
+// reads a file a line at a time, with the same rules as std::getline
+// (lines don't include the '\n', and there's no empty line after a trailing '\n')
+class LineStream
+{
+private:
+    ChunkReader reader;
+    std::string_view chunk;
+    size_t pos = 0;
+    std::string carry;          // the start of a line which ran off the end of the last chunk
+    bool carry_used = false;
+
+public:
+    explicit LineStream(const std::string& filename, size_t chunk_size = ChunkReader::default_chunk_size);
+
+    // read the next line, returns false at the end of the file
+    bool next(std::string_view& line);
+};
+
+
+// reads a file a whitespace-separated token at a time
+class TokenStream
+{
+private:
+    ChunkReader reader;
+    std::string_view chunk;
+    size_t pos = 0;
+    std::string carry;          // the start of a token which ran off the end of the last chunk
+    bool carry_used = false;
+
+public:
+    explicit TokenStream(const std::string& filename, size_t chunk_size = ChunkReader::default_chunk_size);
+
+    // read the next token, returns false at the end of the file
+    bool next(std::string_view& token);
+};
+
+
+#endif //AOC2018_LINE_STREAM_H
@@ -0,0 +1,36 @@
+//
+// Created by wuggy on 17/10/26.
+//
+
+#ifndef AOC2018_PARALLEL_PARSING_H
+#define AOC2018_PARALLEL_PARSING_H
+
+#include <vector>
+
+#include "file_parsing.h"
+
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+
+// below this many lines, a plain serial convert_strings is quicker than handing the work out
+constexpr size_t parallel_convert_threshold = 4096;
+
+// convert_strings, but spread over the tbb workers once there are enough lines to make it worthwhile
+// the converter is called concurrently, so it must be safe to call from several threads at once
+template<typename T, typename Line, typename Converter>
+std::vector<T> convert_strings_parallel(const std::vector<Line> &s, const Converter& c, size_t threshold = parallel_convert_threshold)
+{
+    if (s.size() < threshold) return convert_strings<T>(s, c);
+
+    // preallocate, so that each worker can just write into its own slice of the output
+    std::vector<T> converted(s.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, s.size()), [&](const tbb::blocked_range<size_t>& range)
+    {
+        for (size_t i = range.begin(); i < range.end(); ++i) converted[i] = c(s[i]);
+    });
+
+    return converted;
+}
+
+
+#endif //AOC2018_PARALLEL_PARSING_H
@@ -0,0 +1,303 @@
+//
+// Created by wuggy on 17/10/26.
+//
+
+#ifndef AOC2018_POINT_H
+#define AOC2018_POINT_H
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "hash.h"
+
+// An N-dimensional integer point, for the puzzles which measure everything in manhattan distance.
+// Like Point in grid.h there are no comparison operators beyond ==, since puzzles want different orderings:
+// pass one of the ordering functors below to sort/map/set instead.
+template<size_t N, typename Coord = int>
+struct PointN
+{
+    static_assert(std::is_integral<Coord>::value && std::is_signed<Coord>::value, "PointN needs a signed integer coordinate");
+
+    typedef Coord coord_type;
+    static constexpr size_t dimensions = N;
+
+    std::array<Coord, N> v{};
+
+    constexpr Coord& operator[](size_t i) { return v[i]; }
+    constexpr const Coord& operator[](size_t i) const { return v[i]; }
+
+    constexpr PointN& operator+=(const PointN& o)
+    {
+        for (size_t i = 0; i < N; ++i) v[i] += o.v[i];
+        return *this;
+    }
+
+    constexpr PointN& operator-=(const PointN& o)
+    {
+        for (size_t i = 0; i < N; ++i) v[i] -= o.v[i];
+        return *this;
+    }
+
+    constexpr PointN operator+(const PointN& o) const
+    {
+        PointN r = *this;
+        return r += o;
+    }
+
+    constexpr PointN operator-(const PointN& o) const
+    {
+        PointN r = *this;
+        return r -= o;
+    }
+
+    constexpr PointN operator*(Coord s) const
+    {
+        PointN r = *this;
+        for (size_t i = 0; i < N; ++i) r.v[i] *= s;
+        return r;
+    }
+
+    constexpr bool operator==(const PointN& o) const
+    {
+        for (size_t i = 0; i < N; ++i)
+        {
+            if (v[i] != o.v[i]) return false;
+        }
+        return true;
+    }
+
+    constexpr bool operator!=(const PointN& o) const
+    {
+        return !(*this == o);
+    }
+};
+
+
+template<typename Coord>
+constexpr Coord abs_coord(Coord c)
+{
+    return c < 0 ? -c : c;
+}
+
+template<size_t N, typename Coord>
+constexpr Coord manhattan(const PointN<N, Coord>& a, const PointN<N, Coord>& b)
+{
+    Coord d = 0;
+    for (size_t i = 0; i < N; ++i) d += abs_coord(a.v[i] - b.v[i]);
+    return d;
+}
+
+template<size_t N, typename Coord>
+constexpr Coord manhattan_from_origin(const PointN<N, Coord>& a)
+{
+    Coord d = 0;
+    for (size_t i = 0; i < N; ++i) d += abs_coord(a.v[i]);
+    return d;
+}
+
+
+// orderings
+// lexicographic compares the first coordinate first, reading order compares the last first (so for 2d
+// points stored as {x, y}, that's top to bottom then left to right)
+struct LexicographicOrder
+{
+    template<size_t N, typename Coord>
+    constexpr bool operator()(const PointN<N, Coord>& a, const PointN<N, Coord>& b) const
+    {
+        for (size_t i = 0; i < N; ++i)
+        {
+            if (a.v[i] != b.v[i]) return a.v[i] < b.v[i];
+        }
+        return false;
+    }
+};
+
+struct ReadingOrder
+{
+    template<size_t N, typename Coord>
+    constexpr bool operator()(const PointN<N, Coord>& a, const PointN<N, Coord>& b) const
+    {
+        for (size_t i = N; i-- > 0;)
+        {
+            if (a.v[i] != b.v[i]) return a.v[i] < b.v[i];
+        }
+        return false;
+    }
+};
+
+// nearest the origin first (ties are broken lexicographically, so it's a strict weak ordering)
+struct OriginDistanceOrder
+{
+    template<size_t N, typename Coord>
+    constexpr bool operator()(const PointN<N, Coord>& a, const PointN<N, Coord>& b) const
+    {
+        Coord da = manhattan_from_origin(a);
+        Coord db = manhattan_from_origin(b);
+        if (da != db) return da < db;
+        return LexicographicOrder()(a, b);
+    }
+};
+
+
+namespace std
+{
+    template<size_t N, typename Coord> struct hash<PointN<N, Coord>>
+    {
+        size_t operator()(const PointN<N, Coord>& p) const noexcept
+        {
+            uint64_t h = 0;
+            size_t i = 0;
+            if constexpr (sizeof(Coord) <= sizeof(int))
+            {
+                // two coordinates at a time
+                for (; i + 2 <= N; i += 2) h = hash_combine(h, pack_ints(int(p.v[i]), int(p.v[i + 1])));
+            }
+            for (; i < N; ++i) h = hash_combine(h, uint64_t(p.v[i]));
+            return h;
+        }
+    };
+}
+
+
+// A pile of points stored a coordinate at a time (structure of arrays), so that batches of them can be
+// worked on with SIMD - see distances() below.
+template<size_t N, typename Coord = int>
+class PointsSoA
+{
+private:
+    std::array<std::vector<Coord>, N> axes;
+
+public:
+    typedef PointN<N, Coord> point_type;
+
+    PointsSoA() = default;
+
+    explicit PointsSoA(const std::vector<point_type>& points)
+    {
+        for (auto& a : axes) a.reserve(points.size());
+        for (const auto& p : points) push_back(p);
+    }
+
+    void push_back(const point_type& p)
+    {
+        for (size_t i = 0; i < N; ++i) axes[i].push_back(p.v[i]);
+    }
+
+    point_type operator[](size_t i) const
+    {
+        point_type p;
+        for (size_t d = 0; d < N; ++d) p.v[d] = axes[d][i];
+        return p;
+    }
+
+    // all of the points' coordinates along one axis
+    const Coord* axis(size_t d) const
+    {
+        return axes[d].data();
+    }
+
+    size_t size() const
+    {
+        return axes[0].size();
+    }
+
+    bool empty() const
+    {
+        return axes[0].empty();
+    }
+};
+
+
+namespace point_detail
+{
+    template<size_t N, typename Coord>
+    void distances_scalar(const PointN<N, Coord>& q, const PointsSoA<N, Coord>& points, size_t begin, Coord* out)
+    {
+        for (size_t i = begin; i < points.size(); ++i)
+        {
+            Coord d = 0;
+            for (size_t a = 0; a < N; ++a) d += abs_coord(points.axis(a)[i] - q.v[a]);
+            out[i] = d;
+        }
+    }
+
+#if defined(__x86_64__)
+    inline bool cpu_has_avx2()
+    {
+        static const bool has_avx2 = __builtin_cpu_supports("avx2");
+        return has_avx2;
+    }
+
+    // 8 points at a time
+    template<size_t N>
+    __attribute__((target("avx2")))
+    size_t distances_avx2(const PointN<N, int32_t>& q, const PointsSoA<N, int32_t>& points, int32_t* out)
+    {
+        size_t i = 0;
+        for (; i + 8 <= points.size(); i += 8)
+        {
+            __m256i sum = _mm256_setzero_si256();
+            for (size_t a = 0; a < N; ++a)
+            {
+                __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(points.axis(a) + i));
+                sum = _mm256_add_epi32(sum, _mm256_abs_epi32(_mm256_sub_epi32(c, _mm256_set1_epi32(q.v[a]))));
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), sum);
+        }
+        return i;
+    }
+
+    // 4 points at a time (there's no 64-bit abs before avx512, so it's done with the sign mask)
+    template<size_t N>
+    __attribute__((target("avx2")))
+    size_t distances_avx2(const PointN<N, int64_t>& q, const PointsSoA<N, int64_t>& points, int64_t* out)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+
+        size_t i = 0;
+        for (; i + 4 <= points.size(); i += 4)
+        {
+            __m256i sum = zero;
+            for (size_t a = 0; a < N; ++a)
+            {
+                __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(points.axis(a) + i));
+                __m256i d = _mm256_sub_epi64(c, _mm256_set1_epi64x(q.v[a]));
+                __m256i sign = _mm256_cmpgt_epi64(zero, d);
+                sum = _mm256_add_epi64(sum, _mm256_sub_epi64(_mm256_xor_si256(d, sign), sign));
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), sum);
+        }
+        return i;
+    }
+#endif
+}
+
+
+// the manhattan distance from q to every point, into out (which is resized to fit)
+template<size_t N, typename Coord>
+void distances(const PointN<N, Coord>& q, const PointsSoA<N, Coord>& points, std::vector<Coord>& out)
+{
+    out.resize(points.size());
+
+    size_t done = 0;
+#if defined(__x86_64__)
+    if constexpr (std::is_same<Coord, int32_t>::value || std::is_same<Coord, int64_t>::value)
+    {
+        if (point_detail::cpu_has_avx2()) done = point_detail::distances_avx2(q, points, out.data());
+    }
+#endif
+
+    point_detail::distances_scalar(q, points, done, out.data());   // the rest (or all of it, without avx2)
+}
+
+
+#endif //AOC2018_POINT_H
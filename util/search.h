@@ -0,0 +1,242 @@
+//
+// Created by wuggy on 17/10/26.
+//
+
+#ifndef AOC2018_SEARCH_H
+#define AOC2018_SEARCH_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+// An array whose entries can all be forgotten in O(1), for per-node search state that's reused between
+// searches. Each entry carries the generation it was last written in, and reset() just moves on to the
+// next generation (so everything written before reads back as the empty value).
+template<typename T>
+class StampedArray
+{
+private:
+    std::vector<T> values;
+    std::vector<uint32_t> stamps;
+    uint32_t generation = 1;
+    T empty_value;
+
+public:
+    explicit StampedArray(size_t n = 0, const T& empty = T()) : values(n, empty), stamps(n, 0), empty_value(empty) {}
+
+    // new entries start out empty, existing ones are kept
+    void resize(size_t n)
+    {
+        values.resize(n, empty_value);
+        stamps.resize(n, 0);
+    }
+
+    void reset()
+    {
+        if (++generation == 0)
+        {
+            // wrapped around (after 4 billion resets!) - the old stamps could look current again
+            std::fill(stamps.begin(), stamps.end(), 0);
+            generation = 1;
+        }
+    }
+
+    bool contains(size_t i) const
+    {
+        return stamps[i] == generation;
+    }
+
+    const T& get(size_t i) const
+    {
+        return contains(i) ? values[i] : empty_value;
+    }
+
+    void set(size_t i, const T& v)
+    {
+        values[i] = v;
+        stamps[i] = generation;
+    }
+
+    size_t size() const
+    {
+        return values.size();
+    }
+};
+
+
+// A priority queue for small integer priorities that never go backwards (Dial's algorithm): a ring of
+// buckets, one per priority. Every push must be no lower than the last pop, and less than span() above it.
+// Items of the same priority come out in no particular order.
+template<typename T, typename Cost = int>
+class BucketQueue
+{
+private:
+    std::vector<std::vector<T>> buckets;
+    size_t mask = 0;
+    Cost cursor = 0;        // the lowest priority that can be in the queue
+    size_t count = 0;
+
+public:
+    // span must be more than the biggest difference between a pop and a following push
+    explicit BucketQueue(size_t span = 2)
+    {
+        set_span(span);
+    }
+
+    // (only when empty)
+    void set_span(size_t span)
+    {
+        assert(count == 0);
+
+        size_t n = 1;
+        while (n < span) n <<= 1;
+
+        if (n != buckets.size()) buckets.assign(n, {});
+        mask = n - 1;
+    }
+
+    size_t span() const
+    {
+        return buckets.size();
+    }
+
+    // empty the queue and restart at the given priority (the buckets keep their memory)
+    void reset(Cost start = 0)
+    {
+        if (count) for (auto& b : buckets) b.clear();
+        count = 0;
+        cursor = start;
+    }
+
+    void push(Cost priority, const T& item)
+    {
+        assert(priority >= cursor);
+        assert(size_t(priority - cursor) < buckets.size());
+
+        buckets[size_t(priority) & mask].push_back(item);
+        ++count;
+    }
+
+    // remove one of the lowest priority items, and return it with its priority
+    std::pair<Cost, T> pop()
+    {
+        assert(count > 0);
+
+        while (buckets[size_t(cursor) & mask].empty()) ++cursor;
+
+        auto& b = buckets[size_t(cursor) & mask];
+        T item = b.back();
+        b.pop_back();
+        --count;
+
+        return {cursor, item};
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+};
+
+
+// Shortest-path search over a graph of densely numbered nodes, reusable so that repeated searches don't
+// allocate. The graph is a policy class providing:
+//
+//     typedef ... cost_type;                                  // a signed integer
+//     size_t node_count() const;                              // nodes are numbered 0..node_count()-1
+//     template<typename Emit>
+//     void neighbours(size_t node, Emit&& emit) const;        // emit(next_node, step_cost) for each edge
+//     cost_type heuristic(size_t node) const;                 // 0 for BFS/dijkstra, an estimate for A*
+//     cost_type max_step_cost() const;
+//
+// Step costs must be non-negative and the heuristic must be consistent (never drop by more than the step
+// cost along an edge), so the priorities only ever go up and a bucket queue can be used.
+//
+// run() settles nodes in order of distance (plus heuristic), calling visit(node, distance) for each; the
+// search stops when visit returns false or everything reachable is done.
+template<typename Graph>
+class GraphSearch
+{
+public:
+    typedef typename Graph::cost_type cost_type;
+
+private:
+    struct NodeState
+    {
+        cost_type distance = 0;
+        bool settled = false;
+    };
+
+    StampedArray<NodeState> nodes;
+    BucketQueue<size_t, cost_type> open;
+
+public:
+    template<typename Visitor>
+    void run(const Graph& graph, size_t start, Visitor&& visit)
+    {
+        assert(start < graph.node_count());
+
+        nodes.resize(graph.node_count());
+        nodes.reset();
+
+        // f can go up by at most twice the step cost (the step, plus the heuristic getting worse by as much)
+        open.reset();
+        open.set_span(2 * size_t(graph.max_step_cost()) + 1);
+        open.reset(graph.heuristic(start));
+
+        nodes.set(start, {0, false});
+        open.push(graph.heuristic(start), start);
+
+        while (!open.empty())
+        {
+            size_t node = open.pop().second;
+
+            NodeState state = nodes.get(node);
+            if (state.settled) continue;    // a stale entry, already done via a shorter path
+
+            state.settled = true;
+            nodes.set(node, state);
+
+            if (!visit(node, state.distance)) return;
+
+            graph.neighbours(node, [&](size_t next, cost_type step)
+            {
+                assert(step >= 0);
+                cost_type distance = state.distance + step;
+
+                if (nodes.contains(next))
+                {
+                    const NodeState& ns = nodes.get(next);
+                    if (ns.settled || ns.distance <= distance) return;
+                }
+
+                nodes.set(next, {distance, false});
+                open.push(distance + graph.heuristic(next), next);
+            });
+        }
+    }
+
+    // after a run: has this node been settled, and if so how far was it from the start?
+    bool settled(size_t node) const
+    {
+        return node < nodes.size() && nodes.get(node).settled;
+    }
+
+    cost_type distance(size_t node) const
+    {
+        assert(settled(node));
+        return nodes.get(node).distance;
+    }
+};
+
+
+#endif //AOC2018_SEARCH_H
@@ -0,0 +1,135 @@
+//
+// Created by wuggy on 17/10/26.
+//
+
+#ifndef AOC2018_SOLVER_H
+#define AOC2018_SOLVER_H
+
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "batch.h"
+#include "benchmark.h"
+#include "trace.h"
+
+// The common face of every day, so that they can all be run the same way - by their own main, or all
+// together in-process by aoc_all.
+//
+// parse() reads the day's input files from a directory (so several days can run at once without changing
+// directory), and is called again before each run, so it should replace anything parsed before.
+// The parts return their answers as they're printed, and part2() is always called after part1(), so it can
+// carry on from whatever part 1 worked out. Days with no part 2 return an empty string.
+//
+// A few days only get part 2's answer as a by-product of solving part 1 (day 10's message and the time it
+// appears, say). They do all the work in part1(), hand back the saved answer in part2(), and say so with
+// solves_parts_together() - so --bench times them as one "part1+2" phase, rather than timing a part 2 that
+// does nothing.
+//
+// With --stream, parse_streamed() is called instead of parse(). The days that can solve straight from their input
+// file (01 and 08), reading it a chunk at a time so that it never has to fit in memory (see line_stream.h), just
+// note where it is there, and their parts read it as they go. The rest just parse() as usual (day 05 always
+// streams its input anyway).
+//
+// A few more (days 9, 11, 14, 22 and 24) have their puzzle input built into the source, and ignore the directory
+// they're given. They say so with reads_input(), so that batch mode and aocd can refuse to "solve" some other
+// input with them, rather than quietly giving the built-in input's answers.
+class Solver
+{
+public:
+    virtual ~Solver() = default;
+
+    virtual void parse(const std::string& dir) = 0;
+
+    virtual void parse_streamed(const std::string& dir)
+    {
+        parse(dir);
+    }
+
+    virtual std::string part1() = 0;
+    virtual std::string part2() = 0;
+
+    virtual bool solves_parts_together() const
+    {
+        return false;
+    }
+
+    virtual bool reads_input() const
+    {
+        return true;
+    }
+};
+
+
+// turn an answer into a string, the same as printing it
+template<typename T>
+std::string answer(const T& value)
+{
+    std::ostringstream os;
+    os << value;
+    return os.str();
+}
+
+
+// the main for a day: solve the input in the current directory, printing the answers
+// (and timing the parse and each part with --bench, see benchmark.h, or writing the traced spans to a file
+// with --trace <file>, see trace.h).
+// With --stream, the input is read as it's solved rather than parsed first, for the days that can (see above).
+// Given input paths on the command line instead, solve all of those at once (see batch.h).
+inline int run_solver(const std::string& name, std::unique_ptr<Solver> (*make_solver)(), int argc, char* argv[])
+{
+    BenchmarkSuite bench(name, argc, argv);
+
+    std::string trace_filename;
+    bool streamed = false;
+    std::vector<std::string> batch_paths;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--trace" && i + 1 < argc) trace_filename = argv[++i];
+        else if (arg == "--stream") streamed = true;
+        else if (arg.compare(0, 2, "--") != 0) batch_paths.push_back(arg);
+    }
+
+    int result = 0;
+    if (!batch_paths.empty())
+    {
+        result = run_batch(name, make_solver, batch_paths, streamed);
+    }
+    else
+    {
+        auto solver = make_solver();
+
+        bench.phase("parse", [&]
+        {
+            AOC_TRACE_SCOPE("parse");
+            if (streamed) solver->parse_streamed(".");
+            else solver->parse(".");
+        });
+
+        if (solver->solves_parts_together())
+        {
+            std::cout << bench.phase("part1+2", [&] { AOC_TRACE_SCOPE("part1+2"); return solver->part1(); }) << std::endl;
+
+            std::string part2 = solver->part2();
+            if (!part2.empty()) std::cout << part2 << std::endl;
+        }
+        else
+        {
+            std::cout << bench.phase("part1", [&] { AOC_TRACE_SCOPE("part1"); return solver->part1(); }) << std::endl;
+
+            std::string part2 = bench.phase("part2", [&] { AOC_TRACE_SCOPE("part2"); return solver->part2(); });
+            if (!part2.empty()) std::cout << part2 << std::endl;
+        }
+
+        result = bench.report();
+    }
+
+    if (!trace_filename.empty() && !trace_write_file(trace_filename)) return 1;
+
+    return result;
+}
+
+#endif //AOC2018_SOLVER_H
@@ -0,0 +1,263 @@
+//
+// Created by wuggy on 17/10/26.
+//
+
+#ifndef AOC2018_SPATIAL_INDEX_H
+#define AOC2018_SPATIAL_INDEX_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "point.h"
+
+// A k-d tree over PointN for manhattan distance queries, built once from a pile of points.
+// The tree is balanced by splitting each node at the median of its widest axis, and every node keeps the
+// bounding box of its points so whole subtrees can be skipped when they're too far away to matter.
+//
+// Each point can optionally carry a radius, which turns the points into L1 balls (octahedra) so that
+// count_containing() can answer "how many balls is this point inside?".
+//
+// Queries report points by their index in the vector the tree was built from.
+template<size_t N, typename Coord = int>
+class L1KdTree
+{
+public:
+    typedef PointN<N, Coord> point_type;
+
+    static constexpr size_t leaf_size = 8;
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    struct Nearest
+    {
+        size_t index = npos;    // index of a nearest point (npos if the tree is empty)
+        Coord distance = 0;
+        bool unique = false;    // false if another point is exactly as near
+    };
+
+private:
+    struct Node
+    {
+        point_type min;
+        point_type max;
+        Coord max_radius = 0;           // biggest radius of any point below here
+
+        size_t begin = 0;               // range of this node's points in order/points
+        size_t end = 0;
+        size_t left = npos;             // children (both npos for a leaf)
+        size_t right = npos;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<size_t> order;          // the original index of each point, in tree order
+    std::vector<point_type> points;     // the points, in tree order
+    std::vector<Coord> radii;           // the radii, in tree order (empty if none were given)
+
+    size_t build(size_t begin, size_t end)
+    {
+        Node n;
+        n.begin = begin;
+        n.end = end;
+        n.min = n.max = points[begin];
+        for (size_t i = begin; i < end; ++i)
+        {
+            for (size_t a = 0; a < N; ++a)
+            {
+                n.min[a] = std::min(n.min[a], points[i][a]);
+                n.max[a] = std::max(n.max[a], points[i][a]);
+            }
+            if (!radii.empty()) n.max_radius = std::max(n.max_radius, radii[i]);
+        }
+
+        size_t id = nodes.size();
+        nodes.push_back(n);
+
+        if (end - begin <= leaf_size) return id;
+
+        // split on the widest axis at the median
+        size_t axis = 0;
+        for (size_t a = 1; a < N; ++a)
+        {
+            if (n.max[a] - n.min[a] > n.max[axis] - n.min[axis]) axis = a;
+        }
+
+        size_t mid = begin + (end - begin) / 2;
+        std::vector<size_t> perm(end - begin);
+        std::iota(perm.begin(), perm.end(), begin);
+        std::nth_element(perm.begin(), perm.begin() + (mid - begin), perm.end(),
+                         [this, axis](size_t a, size_t b) { return points[a][axis] < points[b][axis]; });
+        apply_permutation(begin, perm);
+
+        // nodes may be reallocated by the recursion, so don't hold a reference across it
+        size_t left = build(begin, mid);
+        size_t right = build(mid, end);
+        nodes[id].left = left;
+        nodes[id].right = right;
+        return id;
+    }
+
+    void apply_permutation(size_t begin, const std::vector<size_t>& perm)
+    {
+        std::vector<point_type> p;
+        std::vector<size_t> o;
+        std::vector<Coord> r;
+        p.reserve(perm.size());
+        o.reserve(perm.size());
+        for (size_t i : perm)
+        {
+            p.push_back(points[i]);
+            o.push_back(order[i]);
+            if (!radii.empty()) r.push_back(radii[i]);
+        }
+
+        std::copy(p.begin(), p.end(), points.begin() + begin);
+        std::copy(o.begin(), o.end(), order.begin() + begin);
+        if (!radii.empty()) std::copy(r.begin(), r.end(), radii.begin() + begin);
+    }
+
+    // the manhattan distance from q to the nearest point of a node's bounding box
+    static Coord distance_to_box(const point_type& q, const Node& n)
+    {
+        Coord d = 0;
+        for (size_t a = 0; a < N; ++a)
+        {
+            if (q[a] < n.min[a]) d += n.min[a] - q[a];
+            else if (q[a] > n.max[a]) d += q[a] - n.max[a];
+        }
+        return d;
+    }
+
+    void nearest(size_t id, const point_type& q, Nearest& best) const
+    {
+        const Node& n = nodes[id];
+
+        // ties have to be seen to be reported, so only skip boxes that are strictly further away
+        if (best.index != npos && distance_to_box(q, n) > best.distance) return;
+
+        if (n.left == npos)
+        {
+            for (size_t i = n.begin; i < n.end; ++i)
+            {
+                Coord d = manhattan(q, points[i]);
+                if (best.index == npos || d < best.distance)
+                {
+                    best.index = order[i];
+                    best.distance = d;
+                    best.unique = true;
+                }
+                else if (d == best.distance)
+                {
+                    best.unique = false;
+                }
+            }
+            return;
+        }
+
+        // nearer child first, so the other is more likely to be skipped
+        size_t first = n.left;
+        size_t second = n.right;
+        if (distance_to_box(q, nodes[second]) < distance_to_box(q, nodes[first])) std::swap(first, second);
+
+        nearest(first, q, best);
+        nearest(second, q, best);
+    }
+
+    template<typename Visitor>
+    void within(size_t id, const point_type& q, Coord radius, Visitor& visit) const
+    {
+        const Node& n = nodes[id];
+        if (distance_to_box(q, n) > radius) return;
+
+        if (n.left == npos)
+        {
+            for (size_t i = n.begin; i < n.end; ++i)
+            {
+                if (manhattan(q, points[i]) <= radius) visit(order[i]);
+            }
+            return;
+        }
+
+        within(n.left, q, radius, visit);
+        within(n.right, q, radius, visit);
+    }
+
+    size_t count_containing(size_t id, const point_type& q) const
+    {
+        const Node& n = nodes[id];
+        if (distance_to_box(q, n) > n.max_radius) return 0;
+
+        if (n.left == npos)
+        {
+            size_t count = 0;
+            for (size_t i = n.begin; i < n.end; ++i) count += (manhattan(q, points[i]) <= radii[i]);
+            return count;
+        }
+
+        return count_containing(n.left, q) + count_containing(n.right, q);
+    }
+
+public:
+    L1KdTree() = default;
+
+    explicit L1KdTree(const std::vector<point_type>& pts) : L1KdTree(pts, {}) {}
+
+    // radii is either empty, or has one radius per point
+    L1KdTree(const std::vector<point_type>& pts, const std::vector<Coord>& rs) : points(pts), radii(rs)
+    {
+        assert(radii.empty() || radii.size() == points.size());
+
+        order.resize(points.size());
+        std::iota(order.begin(), order.end(), 0);
+
+        if (!points.empty()) build(0, points.size());
+    }
+
+    size_t size() const
+    {
+        return points.size();
+    }
+
+    bool empty() const
+    {
+        return points.empty();
+    }
+
+    // the nearest point to q, and whether it's the only one that near
+    Nearest nearest(const point_type& q) const
+    {
+        Nearest best;
+        if (!nodes.empty()) nearest(0, q, best);
+        return best;
+    }
+
+    // call visit(index) for every point within radius of q (inclusive), in no particular order
+    template<typename Visitor>
+    void within(const point_type& q, Coord radius, Visitor visit) const
+    {
+        if (!nodes.empty()) within(0, q, radius, visit);
+    }
+
+    // the indices of every point within radius of q (inclusive), in no particular order
+    std::vector<size_t> within(const point_type& q, Coord radius) const
+    {
+        std::vector<size_t> found;
+        within(q, radius, [&found](size_t i) { found.push_back(i); });
+        return found;
+    }
+
+    // how many of the points' balls q is inside (a point is inside a ball if it's within the ball's radius)
+    size_t count_containing(const point_type& q) const
+    {
+        assert(!radii.empty() || points.empty());   // only meaningful if radii were given
+
+        if (nodes.empty()) return 0;
+        return count_containing(0, q);
+    }
+};
+
+
+#endif //AOC2018_SPATIAL_INDEX_H
@@ -0,0 +1,222 @@
+//
+// Created by wuggy on 17/10/26.
+//
+
+#ifndef AOC2018_TRACE_H
+#define AOC2018_TRACE_H
+
+#include <string>
+
+// Scoped tracing of the hot paths inside a solver, to see where the time actually goes (which a --bench
+// table of whole phases can't tell you).
+//
+//     Point find_matching_point(...)
+//     {
+//         AOC_TRACE_SCOPE("find_matching_point");
+//         ...
+//     }
+//
+// records a span from there to the end of the scope. Spans go into a ring buffer owned by the thread that
+// made them (so recording never takes a lock, and the TBB workers each get their own track), and
+// trace_write_file() writes them all out as Chrome trace-event JSON, for chrome://tracing or ui.perfetto.dev.
+//
+// Tracing is only compiled in when AOC_TRACE is defined (cmake -DAOC_TRACE=ON). Otherwise AOC_TRACE_SCOPE
+// is nothing at all, and trace_write_file() just says so and returns false.
+//
+// Span names must be string literals (or otherwise live forever) - only the pointer is kept.
+// Each thread keeps its most recent trace_detail::ring_size spans; older ones are overwritten.
+
+
+#ifdef AOC_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace trace_detail
+{
+    typedef std::chrono::steady_clock clock;
+
+    constexpr size_t ring_size = size_t(1) << 16;   // spans kept per thread (a power of 2)
+
+    struct Span
+    {
+        const char* name;
+        int64_t start_ns;
+        int64_t duration_ns;
+    };
+
+    // one thread's spans. Only the owning thread writes, and it publishes each span by bumping 'written',
+    // so the writer can read up to 'written' without stopping anything (but should be called once the
+    // traced work is done, or the oldest spans it reads might be being overwritten under it)
+    struct ThreadBuffer
+    {
+        int tid;
+        std::unique_ptr<Span[]> spans{new Span[ring_size]};
+        std::atomic<uint64_t> written{0};
+
+        explicit ThreadBuffer(int t) : tid(t)
+        {
+        }
+
+        void record(const char* name, int64_t start_ns, int64_t duration_ns)
+        {
+            const uint64_t n = written.load(std::memory_order_relaxed);
+            spans[n & (ring_size - 1)] = Span{name, start_ns, duration_ns};
+            written.store(n + 1, std::memory_order_release);
+        }
+    };
+
+    // every thread's buffer, kept until exit (so the spans of threads that have finished still get written)
+    struct Registry
+    {
+        const clock::time_point epoch = clock::now();
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+        ThreadBuffer* add_thread()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            buffers.push_back(std::make_unique<ThreadBuffer>(static_cast<int>(buffers.size())));
+            return buffers.back().get();
+        }
+    };
+
+    inline Registry& registry()
+    {
+        static Registry r;
+        return r;
+    }
+
+    // the calling thread's buffer, registered the first time it's needed
+    inline ThreadBuffer& this_thread_buffer()
+    {
+        static thread_local ThreadBuffer* buffer = registry().add_thread();
+        return *buffer;
+    }
+
+    inline int64_t now_ns()
+    {
+        const clock::time_point epoch = registry().epoch;   // (before now(), in case this is the first call)
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - epoch).count();
+    }
+
+    inline void write_json_string(std::ostream& os, const char* s)
+    {
+        os << '"';
+        for (; *s; ++s)
+        {
+            if (*s == '"' || *s == '\\') os << '\\';
+            os << *s;
+        }
+        os << '"';
+    }
+}
+
+
+class TraceScope
+{
+private:
+    const char* name;
+    int64_t start_ns;
+
+public:
+    explicit TraceScope(const char* span_name) : name(span_name), start_ns(trace_detail::now_ns())
+    {
+    }
+
+    ~TraceScope()
+    {
+        const int64_t end_ns = trace_detail::now_ns();
+        trace_detail::this_thread_buffer().record(name, start_ns, end_ns - start_ns);
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+};
+
+#define AOC_TRACE_CONCAT_(a, b) a##b
+#define AOC_TRACE_CONCAT(a, b) AOC_TRACE_CONCAT_(a, b)
+#define AOC_TRACE_SCOPE(name) TraceScope AOC_TRACE_CONCAT(aoc_trace_scope_, __LINE__)(name)
+
+
+// write every thread's spans as a trace-event JSON object, returning how many were written
+inline size_t trace_write_json(std::ostream& os)
+{
+    using namespace trace_detail;
+
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    size_t count = 0;
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    for (const auto& buffer : r.buffers)
+    {
+        // name the track (thread 0 is whichever thread traced first, usually main)
+        if (buffer->tid > 0) os << ",";
+        os << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+           << ",\"args\":{\"name\":\"thread " << buffer->tid << "\"}}";
+
+        // the spans still in the ring, oldest first (timestamps are in microseconds)
+        const uint64_t written = buffer->written.load(std::memory_order_acquire);
+        const uint64_t first = written > ring_size ? written - ring_size : 0;
+        for (uint64_t i = first; i < written; ++i)
+        {
+            const Span& s = buffer->spans[i & (ring_size - 1)];
+            os << ",\n{\"name\":";
+            write_json_string(os, s.name);
+            os << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid
+               << ",\"ts\":" << s.start_ns / 1000 << "." << std::setfill('0') << std::setw(3) << s.start_ns % 1000
+               << ",\"dur\":" << s.duration_ns / 1000 << "." << std::setw(3) << s.duration_ns % 1000 << std::setfill(' ')
+               << "}";
+            ++count;
+        }
+
+        if (first > 0)
+        {
+            std::cerr << "trace: thread " << buffer->tid << " overflowed its ring, only its last " << ring_size
+                      << " of " << written << " spans were kept" << std::endl;
+        }
+    }
+    os << "\n]}" << std::endl;
+
+    return count;
+}
+
+
+inline bool trace_write_file(const std::string& filename)
+{
+    std::ofstream f(filename);
+    if (!f)
+    {
+        std::cerr << "trace: can't write " << filename << std::endl;
+        return false;
+    }
+
+    trace_write_json(f);
+    return static_cast<bool>(f);
+}
+
+#else
+
+#include <iostream>
+
+#define AOC_TRACE_SCOPE(name) static_cast<void>(0)
+
+inline bool trace_write_file(const std::string&)
+{
+    std::cerr << "trace: not compiled in, configure with -DAOC_TRACE=ON" << std::endl;
+    return false;
+}
+
+#endif
+
+
+#endif //AOC2018_TRACE_H